@@ -3,3 +3,7 @@ const int SCREEN_WIDTH = 160;
 const int SCREEN_HEIGHT = 144;
 
 const int SCALE = 4;
+
+// 0 follows the display refresh rate
+const int TARGET_FPS = 0;
+const bool VSYNC = true;
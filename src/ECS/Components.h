@@ -1,10 +1,12 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "ECS/Entity.h"
 #include "Game/Graphics/PixelShader.h"
 #include "Game/Graphics/Texture.h"
+#include "Game/Graphics/TextureAtlas.h"
 #include "Game/Graphics/Tile.h"
 
 struct NameComponent {
@@ -21,6 +23,9 @@ struct SpeedComponent {
   int y;
 };
 
+// how a sprite is loaded and animated. the frame it shows while running
+// lives in its SpriteRenderComponent, xIndex and yIndex here only pick the
+// frame it starts on
 struct SpriteComponent {
   std::string name;
   int w = -1;
@@ -30,11 +35,54 @@ struct SpriteComponent {
   int animationFrames = 0;
   int animationDuration = 0;
   PixelShader shader = { nullptr, "" };
-  Uint32 lastUpdate = 0;
   bool once = false;
   Uint32 delay = 0;
 };
 
+// the per frame part of a sprite, created by the sprite setup system. it is
+// kept small and trivially copyable so the render loop walks packed arrays
+struct SpriteRenderComponent {
+  const AtlasSprite* frames = nullptr;
+  int xIndex = 0;
+  int yIndex = 0;
+  bool animated = false;  // animated sprites can't be cached in a static layer
+};
+
+static_assert(std::is_trivially_copyable_v<SpriteRenderComponent>);
+
+// a sprite's animation compiled against the scene clock. the frame is a
+// direct function of the time, nothing accumulates between updates, so the
+// same clock always gives the same frame
+struct AnimationComponent {
+  Uint32 start = 0;  // scene clock of the first frame, the delay folded in
+  Uint32 duration = 1;  // milliseconds for all the frames
+  int frames = 1;
+  int first = 0;  // frame the clip starts on
+  bool once = false;  // stops on the last frame instead of looping
+
+  int frameAt(Uint32 now) const {
+    if (now < start) {
+      return first;
+    }
+
+    Uint64 step = Uint64(now - start) * frames / duration;
+    if (once) {
+      return step >= Uint64(frames - 1 - first) ? frames - 1 : first + step;
+    }
+    return (first + step) % frames;
+  }
+};
+
+inline AnimationComponent compileAnimation(const SpriteComponent& sprite, Uint32 now) {
+  return {
+    now + sprite.delay,
+    Uint32(sprite.animationDuration > 0 ? sprite.animationDuration : 1),
+    sprite.animationFrames,
+    sprite.xIndex,
+    sprite.once
+  };
+}
+
 struct TilemapComponent {
   std::vector<Tile> tilemap;
   int width;
@@ -2,38 +2,39 @@
 
 #include <entt/entt.hpp>
 #include "print.h"
-#include "Scene/Scene.h"
 
+// A lightweight handle to an entity, copy it around freely. It doesn't own
+// anything, the scene that created the entity destroys it when the scene is
+// torn down.
 class Entity
 {
   public:
-    Entity(entt::entity e, Scene* s) {
-      /* print("Entity Created"); */
+    Entity() = default;
+    Entity(entt::entity e, entt::registry& r)
+      : handle(e), registry(&r) { }
 
-      handle = e;
-      scene = s;
-    }
-    ~Entity() {
-      /* print("Entity Destroyed"); */
-      scene->r.destroy(handle);
+    explicit operator bool() const {
+      return registry != nullptr && registry->valid(handle);
     }
 
+    entt::entity id() const { return handle; }
+
     template<typename T>
     auto& addComponent(auto&&... args) {
-      return scene->r.emplace<T>(handle, std::forward<decltype(args)>(args)...);
+      return registry->emplace<T>(handle, std::forward<decltype(args)>(args)...);
     }
 
     template<typename T>
     void removeComponent() {
-      scene->r.remove<T>(handle);
+      registry->remove<T>(handle);
     }
 
     template<typename T>
     auto& get(auto&&... args) {
-      return scene->r.get_or_emplace<T>(handle, std::forward<decltype(args)>(args)...);
+      return registry->get_or_emplace<T>(handle, std::forward<decltype(args)>(args)...);
     }
 
   private:
-    entt::entity handle;
-    Scene* scene;
+    entt::entity handle = entt::null;
+    entt::registry* registry = nullptr;
 };
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <tuple>
+#include <utility>
+#include "ECS/System.h"
+
+// A fixed list of concrete systems that the scene sees as a single system.
+// The members are called through their own type instead of the vtable, so
+// the compiler can inline the whole list and the scene pays one virtual call
+// for it per frame. Scenes that are put together at runtime keep adding
+// systems one by one, both can be mixed freely.
+template<typename Base, typename... Systems>
+class Pipeline : public Base {
+  public:
+    Pipeline(Systems... systems)
+      : systems(std::move(systems)...) { }
+
+    // hides System::setScene, Game's addXSystem helpers call it on the
+    // concrete type so the members get the scene too
+    void setScene(Scene* s) {
+      System::setScene(s);
+      std::apply([s](auto&... system) { (system.setScene(s), ...); }, systems);
+    }
+
+  protected:
+    template<typename F>
+    void forEach(F&& f) {
+      std::apply([&f](auto&... system) { (f(system), ...); }, systems);
+    }
+
+    template<typename T, typename... Args>
+    static void call(T& system, Args... args) {
+      system.T::run(args...);
+    }
+
+  private:
+    std::tuple<Systems...> systems;
+};
+
+template<typename... Systems>
+class RenderPipeline final : public Pipeline<RenderSystem, Systems...> {
+  public:
+    using Pipeline<RenderSystem, Systems...>::Pipeline;
+
+    void run(SDL_Renderer* renderer) override {
+      this->forEach([renderer](auto& system) { RenderPipeline::call(system, renderer); });
+    }
+};
+
+template<typename... Systems>
+class EventPipeline final : public Pipeline<EventSystem, Systems...> {
+  public:
+    // the scene routes the union of what the members listen to, each member
+    // still only sees its own events
+    EventPipeline(Systems... systems)
+      : Pipeline<EventSystem, Systems...>(std::move(systems)...) {
+      bool declared = true;
+      this->forEach([&declared](auto& system) { declared = declared && system.getSubscription().declared; });
+
+      if (declared) {
+        this->forEach([this](auto& system) { this->listensLike(system.getSubscription()); });
+      }
+    }
+
+    void run(SDL_Event event) override {
+      this->forEach([&event](auto& system) {
+        if (system.getSubscription().wants(event)) {
+          EventPipeline::call(system, event);
+        }
+      });
+    }
+};
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <vector>
+#include <entt/entt.hpp>
 #include "Scene/Scene.h"
 
 class System {
@@ -14,17 +17,119 @@ class System {
 
 class SetupSystem : public System {
   public:
+    // starts loading assets ahead of time, it can run while another scene is
+    // still playing so it must not touch the registry
+    virtual void prepare() {}
     virtual void run() = 0;
 };
 
+// events an event system wants, the scene routes only those to it. systems
+// that don't subscribe to anything get every event
+struct EventSubscription {
+  bool declared = false;
+  std::vector<Uint32> types;
+  std::vector<SDL_Keycode> keys;  // key presses, without any other key event
+
+  bool wants(const SDL_Event& event) const {
+    if (!declared) {
+      return true;
+    }
+
+    if (std::find(types.begin(), types.end(), event.type) != types.end()) {
+      return true;
+    }
+
+    return event.type == SDL_KEYDOWN
+      && std::find(keys.begin(), keys.end(), event.key.keysym.sym) != keys.end();
+  }
+
+  // event types the scene has to route here
+  bool routes(Uint32 type) const {
+    return !declared
+      || std::find(types.begin(), types.end(), type) != types.end()
+      || (type == SDL_KEYDOWN && !keys.empty());
+  }
+};
+
 class EventSystem : public System {
   public:
     virtual void run(SDL_Event event) = 0;
+    const EventSubscription& getSubscription() const { return subscription; }
+
+  protected:
+    template<typename... T>
+    void listensTo(T... types) {
+      subscription.declared = true;
+      (subscription.types.push_back(types), ...);
+    }
+
+    template<typename... T>
+    void listensToKeys(T... keys) {
+      subscription.declared = true;
+      (subscription.keys.push_back(keys), ...);
+    }
+
+    // adds everything another declared subscription listens to
+    void listensLike(const EventSubscription& other) {
+      subscription.declared = true;
+      subscription.types.insert(subscription.types.end(), other.types.begin(), other.types.end());
+      subscription.keys.insert(subscription.keys.end(), other.keys.begin(), other.keys.end());
+    }
+
+  private:
+    EventSubscription subscription;
+};
+
+// components an update system touches, the scheduler runs systems whose
+// accesses don't conflict in parallel. systems that declare nothing are
+// exclusive and run alone, in their original order
+struct SystemAccess {
+  bool declared = false;
+  std::vector<entt::id_type> reads;
+  std::vector<entt::id_type> writes;
+  // creates the component pools up front, so views don't insert into the
+  // registry while other systems are running
+  std::vector<void(*)(entt::registry&)> storages;
+
+  bool conflictsWith(const SystemAccess& other) const {
+    if (!declared || !other.declared) {
+      return true;
+    }
+
+    auto overlaps = [](const auto& a, const auto& b) {
+      return std::find_first_of(a.begin(), a.end(), b.begin(), b.end()) != a.end();
+    };
+
+    return overlaps(writes, other.writes)
+      || overlaps(writes, other.reads)
+      || overlaps(reads, other.writes);
+  }
 };
 
 class UpdateSystem : public System {
   public:
     virtual void run(double dT) = 0;
+    const SystemAccess& getAccess() const { return access; }
+
+  protected:
+    template<typename... T>
+    void reads() { (declare<T>(access.reads), ...); }
+
+    template<typename... T>
+    void writes() { (declare<T>(access.writes), ...); }
+
+    // the system only touches thread safe state outside the registry
+    void independent() { access.declared = true; }
+
+  private:
+    template<typename T>
+    void declare(std::vector<entt::id_type>& ids) {
+      access.declared = true;
+      ids.push_back(entt::type_hash<T>::value());
+      access.storages.push_back([](entt::registry& r) { r.storage<T>(); });
+    }
+
+    SystemAccess access;
 };
 
 class RenderSystem : public System {
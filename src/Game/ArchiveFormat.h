@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of assets.pak, shared by the game and tools/pack. Everything is
+// little endian and read in place from the mapped file:
+//
+//   Header
+//   Entry[entryCount]    sorted by name
+//   names                namesSize bytes, not null terminated
+//   blobs                each one starting on an Alignment boundary
+//
+// Entry names are the paths the files have on disk, like "assets/UI/main.png",
+// so loaders look things up with the same path they'd otherwise open.
+namespace archive {
+
+inline constexpr char Magic[4] = { 'P', 'A', 'K', '1' };
+inline constexpr std::uint32_t Version = 1;
+inline constexpr std::uint32_t Alignment = 16;
+
+enum EntryFlags : std::uint32_t {
+  Compressed = 1,  // a single lz4 block of originalSize bytes
+};
+
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t entryCount;
+  std::uint32_t namesSize;
+};
+
+struct Entry {
+  std::uint64_t offset;  // from the start of the file
+  std::uint64_t size;  // as stored
+  std::uint64_t originalSize;
+  std::uint32_t nameOffset;  // into the names block
+  std::uint32_t nameLength;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == 16);
+static_assert(sizeof(Entry) == 40);
+
+}
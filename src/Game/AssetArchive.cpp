@@ -0,0 +1,174 @@
+#include "AssetArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <print.h>
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+const char* AssetArchive::data = nullptr;
+size_t AssetArchive::size = 0;
+const archive::Entry* AssetArchive::entries = nullptr;
+const char* AssetArchive::names = nullptr;
+std::uint32_t AssetArchive::entryCount = 0;
+std::mutex AssetArchive::mutex;
+std::unordered_map<const archive::Entry*, std::vector<char>> AssetArchive::decompressed;
+
+bool AssetArchive::Open(const std::string& path) {
+  Close();
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(archive::Header))) {
+    close(fd);
+    return false;
+  }
+
+  void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping keeps the file open
+  if (mapped == MAP_FAILED) {
+    print("Failed to map", path);
+    return false;
+  }
+
+  const auto* header = static_cast<const archive::Header*>(mapped);
+  size_t tableEnd = sizeof(archive::Header)
+    + size_t(header->entryCount) * sizeof(archive::Entry)
+    + header->namesSize;
+
+  if (std::memcmp(header->magic, archive::Magic, sizeof(archive::Magic)) != 0
+    || header->version != archive::Version
+    || tableEnd > size_t(info.st_size)) {
+    print("Not a usable asset archive", path);
+    munmap(mapped, info.st_size);
+    return false;
+  }
+
+  // every range is checked here once, so lookups can trust the table. the
+  // sums are kept from wrapping around by comparing against what's left
+  const auto* table = reinterpret_cast<const archive::Entry*>(static_cast<const char*>(mapped) + sizeof(archive::Header));
+  for (std::uint32_t i = 0; i < header->entryCount; i++) {
+    const archive::Entry& entry = table[i];
+    if (entry.nameOffset > header->namesSize
+      || entry.nameLength > header->namesSize - entry.nameOffset
+      || entry.offset > std::uint64_t(info.st_size)
+      || entry.size > std::uint64_t(info.st_size) - entry.offset) {
+      print("Asset archive entry", i, "is out of range", path);
+      munmap(mapped, info.st_size);
+      return false;
+    }
+  }
+
+  data = static_cast<const char*>(mapped);
+  size = info.st_size;
+  entryCount = header->entryCount;
+  entries = table;
+  names = reinterpret_cast<const char*>(entries + entryCount);
+
+  print("Opened asset archive", path, entryCount, "files");
+  return true;
+}
+
+void AssetArchive::Close() {
+  std::lock_guard<std::mutex> lock(mutex);
+  decompressed.clear();
+
+  if (data != nullptr) {
+    munmap(const_cast<char*>(data), size);
+  }
+
+  data = nullptr;
+  size = 0;
+  entries = nullptr;
+  names = nullptr;
+  entryCount = 0;
+}
+
+std::string_view AssetArchive::name(const archive::Entry& entry) {
+  return std::string_view(names + entry.nameOffset, entry.nameLength);
+}
+
+const archive::Entry* AssetArchive::lookup(std::string_view path) {
+  if (data == nullptr) {
+    return nullptr;
+  }
+
+  const archive::Entry* end = entries + entryCount;
+  const archive::Entry* it = std::lower_bound(entries, end, path, [](const archive::Entry& entry, std::string_view path) {
+    return name(entry) < path;
+  });
+
+  if (it == end || name(*it) != path) {
+    return nullptr;
+  }
+  return it;
+}
+
+std::optional<std::string_view> AssetArchive::Find(const std::string& path) {
+  const archive::Entry* entry = lookup(path);
+  if (entry == nullptr) {
+    return std::nullopt;
+  }
+
+  if (!(entry->flags & archive::Compressed)) {
+    return std::string_view(data + entry->offset, entry->size);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = decompressed.find(entry);
+  if (it == decompressed.end()) {
+#ifdef HAVE_LZ4
+    std::vector<char> bytes(entry->originalSize);
+    int written = LZ4_decompress_safe(data + entry->offset, bytes.data(), entry->size, entry->originalSize);
+    if (written != static_cast<int>(entry->originalSize)) {
+      print("Corrupt archive entry", path);
+      return std::nullopt;
+    }
+    it = decompressed.emplace(entry, std::move(bytes)).first;
+#else
+    print("Archive entry is lz4 compressed but lz4 support is not built in", path);
+    return std::nullopt;
+#endif
+  }
+
+  return std::string_view(it->second.data(), it->second.size());
+}
+
+bool AssetArchive::Exists(const std::string& path) {
+  if (lookup(path) != nullptr) {
+    return true;
+  }
+
+  struct stat info;
+  return stat(path.c_str(), &info) == 0;
+}
+
+SDL_RWops* AssetArchive::OpenRW(const std::string& path) {
+  if (auto bytes = Find(path)) {
+    return SDL_RWFromConstMem(bytes->data(), bytes->size());
+  }
+  return SDL_RWFromFile(path.c_str(), "rb");
+}
+
+std::string AssetArchive::ReadText(const std::string& path) {
+  if (auto bytes = Find(path)) {
+    return std::string(*bytes);
+  }
+
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Game/ArchiveFormat.h"
+
+// All the assets packed in one file, built by tools/pack and mapped into
+// memory once at startup. Lookups take the path a file would have on disk
+// and fall back to reading it from disk when there's no archive or the file
+// isn't in it, so loose files keep working during development.
+// Lookups can come from any thread.
+class AssetArchive {
+  public:
+    static bool Open(const std::string& path);
+    static void Close();
+
+    // the bytes of a packed file, valid until Close. lz4 entries are
+    // decompressed the first time they're asked for
+    static std::optional<std::string_view> Find(const std::string& path);
+    static bool Exists(const std::string& path);
+
+    // read only stream, from the archive or from disk. nullptr if neither has it
+    static SDL_RWops* OpenRW(const std::string& path);
+    // the whole file, empty if it doesn't exist
+    static std::string ReadText(const std::string& path);
+
+  private:
+    static const archive::Entry* lookup(std::string_view path);
+    static std::string_view name(const archive::Entry& entry);
+
+    static const char* data;
+    static size_t size;
+    static const archive::Entry* entries;
+    static const char* names;
+    static std::uint32_t entryCount;
+
+    static std::mutex mutex;  // guards the decompressed entries
+    static std::unordered_map<const archive::Entry*, std::vector<char>> decompressed;
+};
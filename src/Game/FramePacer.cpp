@@ -0,0 +1,123 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+FramePacer::FramePacer(int targetFPS)
+  : targetFPS(targetFPS), refreshRate(0), vsync(false)
+{
+  frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+  lastFrameStart = 0;
+  nextDeadline = 0;
+
+  // start pessimistic, the estimate converges after a few frames
+  sleepEstimate = frequency * 0.002;
+  sleepDeviation = 0;
+
+  sampleCount = 0;
+  sampleIndex = 0;
+
+  updateFrameTicks();
+}
+
+void FramePacer::setTargetFPS(int fps)
+{
+  targetFPS = fps;
+  updateFrameTicks();
+}
+
+void FramePacer::setDisplay(int refresh, bool enabled)
+{
+  refreshRate = refresh;
+  vsync = enabled;
+  updateFrameTicks();
+}
+
+void FramePacer::updateFrameTicks()
+{
+  int fps = targetFPS > 0 ? targetFPS : refreshRate;
+  if (fps <= 0) {
+    fps = 60;
+  }
+
+  // the swap already blocks until the next vblank
+  if (vsync && refreshRate > 0 && fps >= refreshRate) {
+    frameTicks = 0;
+  } else {
+    frameTicks = static_cast<Uint64>(frequency / fps);
+  }
+
+  nextDeadline = 0;
+}
+
+void FramePacer::frameStart()
+{
+  Uint64 now = SDL_GetPerformanceCounter();
+
+  if (lastFrameStart) {
+    samples[sampleIndex] = static_cast<float>((now - lastFrameStart) / frequency * 1000.0);
+    sampleIndex = (sampleIndex + 1) % samples.size();
+    sampleCount = std::min(sampleCount + 1, samples.size());
+  }
+
+  lastFrameStart = now;
+}
+
+void FramePacer::frameEnd()
+{
+  if (frameTicks == 0) {
+    return;
+  }
+
+  Uint64 now = SDL_GetPerformanceCounter();
+
+  if (nextDeadline == 0) {
+    nextDeadline = now;
+  }
+  nextDeadline += frameTicks;
+
+  // we fell behind by more than a frame, don't try to catch up with a burst
+  if (now > nextDeadline) {
+    nextDeadline = now;
+    return;
+  }
+
+  sleepUntil(nextDeadline);
+}
+
+void FramePacer::sleepUntil(Uint64 deadline)
+{
+  for (;;) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (now >= deadline) {
+      return;
+    }
+
+    double remaining = static_cast<double>(deadline - now);
+
+    if (remaining > sleepEstimate + 2 * sleepDeviation) {
+      SDL_Delay(1);
+
+      // exponential moving average of the real cost of a 1ms sleep
+      double slept = static_cast<double>(SDL_GetPerformanceCounter() - now);
+      double delta = slept - sleepEstimate;
+      sleepEstimate += 0.1 * delta;
+      sleepDeviation += 0.1 * (std::abs(delta) - sleepDeviation);
+    }
+    // else we spin, the remaining time is shorter than a sleep could honor
+  }
+}
+
+float FramePacer::percentile(float p) const
+{
+  if (sampleCount == 0) {
+    return 0;
+  }
+
+  std::array<float, 256> sorted;
+  std::copy_n(samples.begin(), sampleCount, sorted.begin());
+
+  size_t n = std::min(sampleCount - 1, static_cast<size_t>(p / 100.0f * sampleCount));
+  std::nth_element(sorted.begin(), sorted.begin() + n, sorted.begin() + sampleCount);
+  return sorted[n];
+}
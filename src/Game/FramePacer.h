@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <array>
+
+// Keeps frames on an absolute schedule. When the renderer presents with vsync
+// at the display rate we let the swap do the waiting, otherwise we sleep most
+// of the remaining time and spin the rest, since SDL_Delay alone oversleeps by
+// up to a couple of miliseconds.
+class FramePacer {
+  public:
+    FramePacer(int targetFPS = 60);
+
+    // 0 means "as fast as the display refreshes"
+    void setTargetFPS(int fps);
+    void setDisplay(int refreshRate, bool vsync);
+
+    void frameStart();
+    void frameEnd();
+
+    // frame time percentile (0..100) over the last samples, in miliseconds
+    float percentile(float p) const;
+
+  private:
+    void updateFrameTicks();
+    void sleepUntil(Uint64 deadline);
+
+    int targetFPS;
+    int refreshRate;
+    bool vsync;
+
+    double frequency;  // performance counter ticks per second
+    Uint64 frameTicks;  // 0 when the pacer doesn't wait at all
+    Uint64 lastFrameStart;
+    Uint64 nextDeadline;
+
+    // how long a SDL_Delay(1) really takes here, in ticks, learned as we go
+    double sleepEstimate;
+    double sleepDeviation;
+
+    std::array<float, 256> samples;
+    size_t sampleCount;
+    size_t sampleIndex;
+};
@@ -1,30 +1,99 @@
 #include "Game.h"
 
 #include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <SDL2/SDL_image.h>
 #include <print.h>
 
-Game::Game(const char* title, int width, int height)
+#include "Game/AssetArchive.h"
+#include "Game/Startup.h"
+#include "Game/Graphics/LayerCache.h"
+#include "Game/Graphics/TextureLoader.h"
+
+Game::Game(const char* title, int width, int height, int targetFPS, bool vsync)
 {
-  int maxFPS = 60;
-  frameDuration = (1.0f / maxFPS) * 1000.0f;  // how many mili seconds in one frame
+  // the simulation always advances in fixed steps, rendering runs on its own
+  int updatesPerSecond = 60;
+  dT = 1.0 / updatesPerSecond;
+  maxFrameTime = 0.25;
+  accumulator = 0;
+  rendered = false;
+  hasPresented = false;
+  uploadBudget = 2.0;
 
   // initial frame count variables
   frameCount = 0;
   lastFPSUpdateTime = 0;
   FPS = 0;
 
-  SDL_Init(SDL_INIT_EVERYTHING);
-  
-  window = SDL_CreateWindow(title, 0, 0, width, height, 0);
-  renderer = SDL_CreateRenderer(window, -1, 0);
-  
-  SDL_SetRenderDrawColor(renderer, 200, 255, 255, 1);
+  // the window has to be made on the main thread, everything else that
+  // doesn't need it is done meanwhile
+  StartupGraph startup;
+
+  startup.add("sdl", {}, [] {
+    // audio goes through fmod, no controllers
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER);
+  }, true);
+
+  startup.add("window", { "sdl" }, [&] {
+    window = SDL_CreateWindow(title, 0, 0, width, height, 0);
+    renderer = SDL_CreateRenderer(window, -1, vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
+
+    // vsync is only a request, the driver might have ignored it
+    SDL_RendererInfo rendererInfo;
+    bool hasVSync = SDL_GetRendererInfo(renderer, &rendererInfo) == 0
+      && (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC);
+
+    SDL_DisplayMode displayMode;
+    int refreshRate = 0;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &displayMode) == 0) {
+      refreshRate = displayMode.refresh_rate;
+    }
+
+    pacer.setTargetFPS(targetFPS);
+    pacer.setDisplay(refreshRate, hasVSync);
+    print("Display refresh rate", refreshRate, "vsync", hasVSync);
+
+    SDL_SetRenderDrawColor(renderer, 200, 255, 255, 1);
+  }, true);
 
-  // Initialize TTF
-  if (TTF_Init() == -1) {
-    printf("TTF Init Failed: %s\n", TTF_GetError());
+  // the error is per thread, so it's kept for the main thread to report
+  std::string fontError;
+  startup.add("fonts", {}, [&fontError] {
+    // Initialize TTF
+    if (TTF_Init() == -1) {
+      fontError = TTF_GetError();
+    }
+  });
+
+  startup.add("images", {}, [] {
+    // loads the png codec now rather than on the first decode
+    IMG_Init(IMG_INIT_PNG);
+  });
+
+  startup.add("archive", {}, [] {
+    // built by the assets target next to the executable, ASSET_ARCHIVE=path
+    // to use another one. without it everything is read from assets/
+    std::string path;
+    if (const char* archive = getenv("ASSET_ARCHIVE")) {
+      path = archive;
+    } else if (char* basePath = SDL_GetBasePath()) {
+      path = std::string(basePath) + "assets.pak";
+      SDL_free(basePath);
+    } else {
+      path = "assets.pak";
+    }
+    AssetArchive::Open(path);
+  });
+
+  startup.run();
+
+  if (!fontError.empty()) {
+    printf("TTF Init Failed: %s\n", fontError.c_str());
     exit(1);
   }
 
@@ -35,39 +104,50 @@ Game::Game(const char* title, int width, int height)
 
   isRunning = true;
 
-  frameStartTimestamp = 0;
-  frameEndTimestamp = 0;
+  counterFrequency = static_cast<double>(SDL_GetPerformanceFrequency());
+  frameStartCounter = 0;
+  lastFrameCounter = 0;
 
   currentScene = nullptr;
 }
 
 Game::~Game()
-{}
+{
+  // after the derived game is gone, it may still be streaming from it
+  AssetArchive::Close();
+}
 
 void Game::frameStart()
 {
   /* std::cout << "---- Frame: " << frameCount << " ----" << std::endl; */
-  frameStartTimestamp = SDL_GetTicks();
-  if (frameEndTimestamp)
-  {
-    dT = (frameStartTimestamp - frameEndTimestamp) / 1000.0f;
-  }
-  else
+  pacer.frameStart();
+  frameStartCounter = SDL_GetPerformanceCounter();
+
+  double frameTime = 0;
+  if (lastFrameCounter)
   {
-    dT = 0;
+    frameTime = (frameStartCounter - lastFrameCounter) / counterFrequency;
   }
+  lastFrameCounter = frameStartCounter;
+
+  // after a long stall (model loading, a blocking system) we drop the time
+  // instead of running hundreds of updates to catch up
+  accumulator += std::min(frameTime, maxFrameTime);
 }
 
 void Game::frameEnd()
 {
-  frameEndTimestamp = SDL_GetTicks();
-
-  float actualFrameDuration = frameEndTimestamp - frameStartTimestamp;
-
-  if (actualFrameDuration < frameDuration) {
-    SDL_Delay(frameDuration - actualFrameDuration);
+  if (rendered) {
+    pacer.frameEnd();
+  } else {
+    // nothing was drawn, so we don't have a swap to wait on either. we sleep
+    // until the next simulation step is due, waking up early on input
+    int idleMillis = static_cast<int>((dT - accumulator) * 1000.0);
+    if (idleMillis > 0) {
+      SDL_WaitEventTimeout(nullptr, idleMillis);
+    }
   }
-  
+
   frameCount++;
   // Update FPS counter every second
   Uint32 currentTime = SDL_GetTicks();
@@ -77,7 +157,11 @@ void Game::frameEnd()
 
     if (FPS > 0) {
       std::ostringstream titleStream;
-      titleStream << " FPS: " << static_cast<int>(FPS); 
+      titleStream << " FPS: " << static_cast<int>(FPS);
+      titleStream.precision(3);
+      titleStream << " | p50 " << pacer.percentile(50)
+                  << "ms p95 " << pacer.percentile(95)
+                  << "ms p99 " << pacer.percentile(99) << "ms";
       SDL_SetWindowTitle(window, titleStream.str().c_str());
     }
     frameCount = 0; // Reset frame count after updating FPS
@@ -86,6 +170,8 @@ void Game::frameEnd()
 
 void Game::handleEvents()
 {
+  events.clear();
+
   SDL_Event event;
   while (SDL_PollEvent(&event) != 0) {
     if (event.type == SDL_QUIT) {
@@ -93,34 +179,73 @@ void Game::handleEvents()
     }
 
     if (currentScene != nullptr) {
-      currentScene->update(dT);
+      // exposed, resized or lost render targets, we must draw again
+      if (event.type == SDL_WINDOWEVENT
+        || event.type == SDL_RENDER_TARGETS_RESET
+        || event.type == SDL_RENDER_DEVICE_RESET) {
+        currentScene->markDirty();
+      }
+
+      if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+        LayerCache::invalidateAll();
+      }
+
+      events.push_back(event);
     }
+  }
 
-    currentScene->processEvents(event);
+  // the scene gets the whole frame at once
+  if (currentScene != nullptr && !events.empty()) {
+    currentScene->processEvents(events);
   }
 }
 
 void Game::update()
 {
-  if (currentScene != nullptr) {
+  // between scenes there is nothing to simulate, the time is dropped so the
+  // next scene doesn't start by catching up on it
+  if (currentScene == nullptr) {
+    accumulator = 0;
+    return;
+  }
+
+  // consume the accumulated time in fixed steps, update runs exactly once per step
+  while (accumulator >= dT && currentScene != nullptr) {
     currentScene->update(dT);
+    accumulator -= dT;
   }
 }
 
 void Game::render()
 {
-  if (currentScene != nullptr) {
+  rendered = false;
+
+  // textures decoded in the background reach the gpu a few at a time, so a
+  // scene switch never stalls a whole frame on uploads
+  if (TextureLoader::Upload(uploadBudget) && currentScene != nullptr) {
+    currentScene->markDirty();
+  }
+
+  if (currentScene != nullptr && currentScene->needsRedraw(SDL_GetTicks())) {
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 1);
     SDL_RenderClear(renderer);
   
     currentScene->render(renderer);
 
     SDL_RenderPresent(renderer);
+
+    if (!hasPresented) {
+      hasPresented = true;
+      StartupTimeline::Mark("first frame");
+      StartupTimeline::Report();
+    }
+    rendered = true;
   }
 }
 
 void Game::clean()
 {
+  TextureLoader::tearDown();
   SDL_DestroyWindow(window);
   SDL_DestroyRenderer(renderer);
   SDL_Quit();
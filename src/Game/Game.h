@@ -1,18 +1,22 @@
 #include <SDL2/SDL.h>
 #include <memory>
+#include <memory_resource>
+#include <vector>
 #include "Scene/Scene.h"
+#include "ECS/Pipeline.h"
+#include "Game/FramePacer.h"
 
 
 class Game {
   public:
-    Game(const char* title, int width, int height);
+    Game(const char* title, int width, int height, int targetFPS = 0, bool vsync = true);
     ~Game();
 
     virtual void setup() = 0;
     void frameStart();
     void frameEnd();
     void handleEvents();
-    void update();
+    virtual void update();
     void render();
     void clean();
     bool running();
@@ -33,10 +37,18 @@ class Game {
     int screen_height;
 
     // for frame management
-    Uint32 frameStartTimestamp;
-    Uint32 frameEndTimestamp;
-    float frameDuration;
-    float dT; // time in miliseconds since last frame
+    FramePacer pacer;
+    Uint64 frameStartCounter;
+    Uint64 lastFrameCounter;
+    double counterFrequency;  // performance counter ticks per second
+    // fixed timestep simulation
+    double dT;  // seconds simulated by every update step
+    double maxFrameTime;  // clamp for long stalls so we don't spiral
+    double accumulator;  // unsimulated time carried over between frames
+    bool rendered;  // false when the scene had nothing new to show this frame
+    bool hasPresented;  // the startup timeline is reported after it
+    double uploadBudget;  // milliseconds per frame for texture uploads
+    std::vector<SDL_Event> events;  // polled this frame, reused between frames
     // for frame count
     int frameCount;
     Uint32 lastFPSUpdateTime;
@@ -45,33 +57,59 @@ class Game {
     // scene logic
     Scene* currentScene;
 
+    // systems and their control blocks come out of the scene's arena, so
+    // building a scene costs a handful of pointer bumps and tearing it down
+    // hands the memory back in one go
     template<typename T>
     void addSetupSystem(Scene* scene, auto&&... args) {
-        auto system = std::make_shared<T>(std::forward<decltype(args)>(args)...);
+        auto system = std::allocate_shared<T>(
+            std::pmr::polymorphic_allocator<T>(scene->memory()),
+            std::forward<decltype(args)>(args)...
+        );
         system->setScene(scene);
         scene->setupSystems.push_back(system);
     }
 
     template<typename T>
     void addEventSystem(Scene* scene, auto&&... args) {
-        auto system = std::make_shared<T>(std::forward<decltype(args)>(args)...);
+        auto system = std::allocate_shared<T>(
+            std::pmr::polymorphic_allocator<T>(scene->memory()),
+            std::forward<decltype(args)>(args)...
+        );
         system->setScene(scene);
         scene->eventSystems.push_back(system);
     }
 
     template<typename T>
     void addUpdateSystem(Scene* scene, auto&&... args) {
-        auto system = std::make_shared<T>(std::forward<decltype(args)>(args)...);
+        auto system = std::allocate_shared<T>(
+            std::pmr::polymorphic_allocator<T>(scene->memory()),
+            std::forward<decltype(args)>(args)...
+        );
         system->setScene(scene);
         scene->updateSystems.push_back(system);
     }
 
     template<typename T>
     void addRenderSystem(Scene* scene, auto&&... args) {
-        auto system = std::make_shared<T>(std::forward<decltype(args)>(args)...);
+        auto system = std::allocate_shared<T>(
+            std::pmr::polymorphic_allocator<T>(scene->memory()),
+            std::forward<decltype(args)>(args)...
+        );
         system->setScene(scene);
         scene->renderSystems.push_back(system);
     }
 
+    // for systems a scene always runs together and in this order, see Pipeline
+    template<typename... T>
+    void addRenderPipeline(Scene* scene, T&&... systems) {
+        addRenderSystem<RenderPipeline<std::decay_t<T>...>>(scene, std::forward<T>(systems)...);
+    }
+
+    template<typename... T>
+    void addEventPipeline(Scene* scene, T&&... systems) {
+        addEventSystem<EventPipeline<std::decay_t<T>...>>(scene, std::forward<T>(systems)...);
+    }
+
 
 };
@@ -0,0 +1,113 @@
+#include "IndexedTexture.h"
+
+IndexedTexture::IndexedTexture(SDL_Renderer* renderer)
+  : renderer(renderer) {
+  texture = nullptr;
+  width = 0;
+  height = 0;
+  colorMod = { 255, 255, 255, 255 };
+  expanded = -1;
+
+  variants.push_back({ nullptr, "" });
+}
+
+IndexedTexture::~IndexedTexture() {
+  if (texture) {
+    SDL_DestroyTexture(texture);
+  }
+}
+
+void IndexedTexture::upload(const SDL_Surface* surface) {
+  width = surface->w;
+  height = surface->h;
+
+  // drop the row padding, the indices are only ever read by expand()
+  indices.resize(width * height);
+  for (int y = 0; y < height; y++) {
+    SDL_memcpy(&indices[y * width], static_cast<const Uint8*>(surface->pixels) + y * surface->pitch, width);
+  }
+
+  palettes.assign(variants.size(), {});
+  const SDL_Palette* palette = surface->format->palette;
+  for (int i = 0; i < palette->ncolors && i < 256; i++) {
+    const SDL_Color& c = palette->colors[i];
+    palettes[0][i] = Uint32(c.r) << 24 | Uint32(c.g) << 16 | Uint32(c.b) << 8 | c.a;
+  }
+
+  for (size_t variant = 1; variant < variants.size(); variant++) {
+    buildPalette(variant);
+  }
+
+  if (texture) {
+    SDL_DestroyTexture(texture);
+  }
+  texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  SDL_SetTextureColorMod(texture, colorMod.r, colorMod.g, colorMod.b);
+  expanded = -1;
+}
+
+bool IndexedTexture::isLoaded() const {
+  return texture != nullptr;
+}
+
+int IndexedTexture::addPalette(const PixelShader& shader) {
+  for (size_t i = 0; i < variants.size(); i++) {
+    if (variants[i].name == shader.name) {
+      return i;
+    }
+  }
+
+  variants.push_back(shader);
+  if (!palettes.empty()) {
+    palettes.emplace_back();
+    buildPalette(variants.size() - 1);
+  }
+
+  return variants.size() - 1;
+}
+
+void IndexedTexture::buildPalette(size_t variant) {
+  // the shader sees 256 colors instead of every pixel of the image
+  variants[variant].apply(palettes[0].data(), palettes[variant].data(), 256);
+}
+
+void IndexedTexture::expand(int palette) {
+  void* pixels;
+  int pitch;
+  if (SDL_LockTexture(texture, NULL, &pixels, &pitch) != 0) {
+    return;
+  }
+
+  const std::array<Uint32, 256>& colors = palettes[palette];
+  for (int y = 0; y < height; y++) {
+    const Uint8* src = &indices[y * width];
+    Uint32* dst = reinterpret_cast<Uint32*>(static_cast<Uint8*>(pixels) + y * pitch);
+    for (int x = 0; x < width; x++) {
+      dst[x] = colors[src[x]];
+    }
+  }
+
+  SDL_UnlockTexture(texture);
+  expanded = palette;
+}
+
+void IndexedTexture::render(int palette, int x, int y, int w, int h, SDL_Rect* clip) {
+  if (texture == nullptr || palette < 0 || palette >= static_cast<int>(palettes.size())) {
+    return;
+  }
+
+  if (palette != expanded) {
+    expand(palette);
+  }
+
+  SDL_Rect renderQuad = { x, y, w != 0 ? w : width, h != 0 ? h : height };
+  SDL_RenderCopy(renderer, texture, clip, &renderQuad);
+}
+
+void IndexedTexture::setColorMod(SDL_Color color) {
+  colorMod = color;
+  if (texture) {
+    SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+  }
+}
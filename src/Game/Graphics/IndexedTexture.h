@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <array>
+#include <string>
+#include <vector>
+#include "PixelShader.h"
+
+// An image kept as 8 bit palette indices plus any number of palettes. Palette
+// variants are the file's own palette run through a PixelShader, so each one
+// costs 256 colors instead of a whole RGBA copy of the image. A single RGBA
+// texture is shown at a time, it is expanded on the cpu when a different
+// palette gets drawn, so alternate variants between frames, not within one.
+class IndexedTexture {
+  public:
+    IndexedTexture(SDL_Renderer* renderer);
+    ~IndexedTexture();
+
+    IndexedTexture(const IndexedTexture&) = delete;
+    IndexedTexture& operator=(const IndexedTexture&) = delete;
+
+    // copies the indices and the palette out of an INDEX8 surface
+    void upload(const SDL_Surface* surface);
+    bool isLoaded() const;
+
+    // palette 0 is the file's own, the same shader name gives the same id.
+    // variants can be added before the image is uploaded
+    int addPalette(const PixelShader& shader);
+
+    void render(int palette, int x, int y, int w = 0, int h = 0, SDL_Rect* clip = NULL);
+    void setColorMod(SDL_Color color);
+
+    int width;
+    int height;
+
+  private:
+    void buildPalette(size_t variant);
+    void expand(int palette);
+
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    SDL_Color colorMod;
+    std::vector<Uint8> indices;
+    std::vector<PixelShader> variants;
+    std::vector<std::array<Uint32, 256>> palettes;
+    int expanded;  // palette the texture currently shows
+};
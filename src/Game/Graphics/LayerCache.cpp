@@ -0,0 +1,72 @@
+#include "LayerCache.h"
+
+#include <print.h>
+
+unsigned LayerCache::currentGeneration = 1;
+
+LayerCache::LayerCache(SDL_Renderer* renderer, int width, int height)
+  : renderer(renderer), width(width), height(height) {
+  previousTarget = nullptr;
+  generation = 0;
+
+  texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+  if (texture == nullptr) {
+    print("Failed to create layer cache:", SDL_GetError());
+    return;
+  }
+
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+}
+
+LayerCache::~LayerCache() {
+  if (texture) {
+    SDL_DestroyTexture(texture);
+  }
+}
+
+bool LayerCache::supported(SDL_Renderer* renderer) {
+  return SDL_RenderTargetSupported(renderer);
+}
+
+void LayerCache::invalidateAll() {
+  currentGeneration++;
+}
+
+bool LayerCache::isValid() const {
+  return texture != nullptr && generation == currentGeneration;
+}
+
+bool LayerCache::begin() {
+  // setting a null target would draw the layers over the frame instead
+  if (texture == nullptr) {
+    return false;
+  }
+
+  previousTarget = SDL_GetRenderTarget(renderer);
+  if (SDL_SetRenderTarget(renderer, texture) != 0) {
+    previousTarget = nullptr;
+    return false;
+  }
+
+  // transparent, so whatever is below the layers still shows through
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+  SDL_RenderClear(renderer);
+  return true;
+}
+
+void LayerCache::end() {
+  SDL_SetRenderTarget(renderer, previousTarget);
+  previousTarget = nullptr;
+  generation = currentGeneration;
+}
+
+void LayerCache::render(int x, int y, int w, int h, SDL_Color tint) {
+  if (texture == nullptr) {
+    return;
+  }
+
+  // tinting the composite keeps palette changes from recompositing
+  SDL_SetTextureColorMod(texture, tint.r, tint.g, tint.b);
+  SDL_Rect renderQuad = { x, y, w, h };
+  SDL_RenderCopy(renderer, texture, NULL, &renderQuad);
+}
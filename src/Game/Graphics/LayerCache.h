@@ -0,0 +1,35 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// A render target texture holding pre-composited static layers. Callers draw
+// into it between begin() and end() only when its content changed, and
+// composite it with render() every frame. begin() fails when the texture
+// couldn't be made or can't be drawn into, callers then draw directly.
+class LayerCache {
+  public:
+    LayerCache(SDL_Renderer* renderer, int width, int height);
+    ~LayerCache();
+
+    LayerCache(const LayerCache&) = delete;
+    LayerCache& operator=(const LayerCache&) = delete;
+
+    static bool supported(SDL_Renderer* renderer);
+    // render target contents are lost on SDL_RENDER_TARGETS_RESET
+    static void invalidateAll();
+
+    bool isValid() const;
+    bool begin();
+    void end();
+    void render(int x, int y, int w, int h, SDL_Color tint = { 255, 255, 255, 255 });
+
+  private:
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    SDL_Texture* previousTarget;
+    int width;
+    int height;
+    unsigned generation;
+
+    static unsigned currentGeneration;
+};
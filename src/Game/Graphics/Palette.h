@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <utility>
+#include <SDL.h>
+#include "PixelShader.h"
+
+// four shades, darkest first
+struct Palette {
+  std::array<SDL_Color, 4> colors;
+
+  constexpr const SDL_Color& operator[](size_t i) const { return colors[i]; }
+};
+
+// packed like the pixels of an RGBA8888 surface
+constexpr Uint32 packColor(SDL_Color color) {
+  return Uint32(color.r) << 24 | Uint32(color.g) << 16 | Uint32(color.b) << 8 | color.a;
+}
+
+// shade i of one palette becomes shade i of the other
+struct PaletteMap {
+  std::array<Uint32, 4> from;
+  std::array<Uint32, 4> to;
+};
+
+constexpr PaletteMap mapPalette(const Palette& from, const Palette& to) {
+  PaletteMap map = {};
+  for (size_t i = 0; i < 4; i++) {
+    map.from[i] = packColor(from[i]);
+    map.to[i] = packColor(to[i]);
+  }
+  return map;
+}
+
+// exact swap of every shade that changes, applied when a texture is decoded
+// by the remap kernel. a map that changes nothing is no shader at all
+inline PixelShader paletteShader(const PaletteMap& map, const std::string& name) {
+  std::array<std::pair<Uint32, Uint32>, 4> colors;
+  size_t count = 0;
+  for (size_t i = 0; i < 4; i++) {
+    if (map.from[i] != map.to[i]) {
+      colors[count++] = { map.from[i], map.to[i] };
+    }
+  }
+
+  if (count == 0) {
+    return { nullptr, "" };
+  }
+
+  PixelShader shader = PixelShader::paletteRemap(std::span(colors.data(), count));
+  shader.name = name;
+  return shader;
+}
@@ -0,0 +1,218 @@
+#include "PixelShader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <print.h>
+
+#ifndef NDEBUG
+#include <random>
+#include <vector>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define SHADER_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define SHADER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// lets the avx2 kernels live next to the rest without building everything
+// with -mavx2, they only run after the cpu check
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+// Pixels are RGBA8888 packed as 0xRRGGBBAA. Every vector kernel handles the
+// bulk of the span and leaves the remainder to the scalar one, and matches
+// it exactly so the result never depends on the cpu. Debug builds check
+// that before a vector kernel is picked.
+
+namespace {
+
+struct Kernel {
+  PixelSpan paletteRemap;
+  const char* isa;
+};
+
+void paletteRemapScalar(const Uint32* src, Uint32* dst, size_t n, const ShaderParams& params) {
+  for (size_t i = 0; i < n; i++) {
+    const Uint32 p = src[i];
+    Uint32 out = p;
+    for (int c = 0; c < params.count; c++) {
+      if (p == params.from[c]) {
+        out = params.to[c];
+      }
+    }
+    dst[i] = out;
+  }
+}
+
+const Kernel scalarKernel = { paletteRemapScalar, "scalar" };
+
+#ifdef SHADER_X86
+
+void paletteRemapSSE2(const Uint32* src, Uint32* dst, size_t n, const ShaderParams& params) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i out = p;
+    for (int c = 0; c < params.count; c++) {
+      __m128i hit = _mm_cmpeq_epi32(p, _mm_set1_epi32(params.from[c]));
+      out = _mm_or_si128(_mm_andnot_si128(hit, out), _mm_and_si128(hit, _mm_set1_epi32(params.to[c])));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+  }
+  paletteRemapScalar(src + i, dst + i, n - i, params);
+}
+
+const Kernel sse2Kernel = { paletteRemapSSE2, "sse2" };
+
+TARGET_AVX2 void paletteRemapAVX2(const Uint32* src, Uint32* dst, size_t n, const ShaderParams& params) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i out = p;
+    for (int c = 0; c < params.count; c++) {
+      __m256i hit = _mm256_cmpeq_epi32(p, _mm256_set1_epi32(params.from[c]));
+      out = _mm256_blendv_epi8(out, _mm256_set1_epi32(params.to[c]), hit);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+  }
+  paletteRemapScalar(src + i, dst + i, n - i, params);
+}
+
+const Kernel avx2Kernel = { paletteRemapAVX2, "avx2" };
+
+#endif
+
+#ifdef SHADER_NEON
+
+void paletteRemapNEON(const Uint32* src, Uint32* dst, size_t n, const ShaderParams& params) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    uint32x4_t p = vld1q_u32(src + i);
+    uint32x4_t out = p;
+    for (int c = 0; c < params.count; c++) {
+      uint32x4_t hit = vceqq_u32(p, vdupq_n_u32(params.from[c]));
+      out = vbslq_u32(hit, vdupq_n_u32(params.to[c]), out);
+    }
+    vst1q_u32(dst + i, out);
+  }
+  paletteRemapScalar(src + i, dst + i, n - i, params);
+}
+
+const Kernel neonKernel = { paletteRemapNEON, "neon" };
+
+#endif
+
+#ifndef NDEBUG
+// runs a kernel against the scalar one on random spans of every length up
+// to a few vectors, so the tails are covered too. pixels come partly from
+// the remap colors, so the replacing path is hit
+bool matchesScalar(const Kernel& candidate) {
+  std::mt19937 random(0x5eed);
+
+  ShaderParams params;
+  params.count = params.from.size();
+  for (int c = 0; c < params.count; c++) {
+    params.from[c] = random();
+    params.to[c] = random();
+  }
+
+  for (size_t n = 0; n <= 40; n++) {
+    std::vector<Uint32> src(n);
+    for (Uint32& pixel : src) {
+      pixel = random() % 2 ? params.from[random() % params.count] : Uint32(random());
+    }
+
+    std::vector<Uint32> expected(n);
+    std::vector<Uint32> actual(n);
+    scalarKernel.paletteRemap(src.data(), expected.data(), n, params);
+    candidate.paletteRemap(src.data(), actual.data(), n, params);
+
+    if (expected != actual) {
+      print("Pixel shader kernel for", candidate.isa, "differs from scalar on", n, "pixels, not using it");
+      return false;
+    }
+  }
+
+  return true;
+}
+#else
+bool matchesScalar(const Kernel&) {
+  return true;
+}
+#endif
+
+const Kernel& selectKernel() {
+  // SCALAR_SHADERS=1 to compare against the reference kernel
+  if (getenv("SCALAR_SHADERS") != nullptr) {
+    return scalarKernel;
+  }
+
+#ifdef SHADER_X86
+  if (SDL_HasAVX2() && matchesScalar(avx2Kernel)) {
+    return avx2Kernel;
+  }
+  if (SDL_HasSSE2() && matchesScalar(sse2Kernel)) {
+    return sse2Kernel;
+  }
+#endif
+
+#ifdef SHADER_NEON
+  if (SDL_HasNEON() && matchesScalar(neonKernel)) {
+    return neonKernel;
+  }
+#endif
+
+  return scalarKernel;
+}
+
+const Kernel& kernel() {
+  static const Kernel& selected = selectKernel();
+  return selected;
+}
+
+std::string hex(Uint32 color) {
+  char buffer[9];
+  snprintf(buffer, sizeof(buffer), "%08X", color);
+  return buffer;
+}
+
+}
+
+void PixelShader::apply(const Uint32* src, Uint32* dst, size_t n) const {
+  if (span != nullptr) {
+    span(src, dst, n, params);
+    return;
+  }
+
+  if (func != nullptr) {
+    for (size_t i = 0; i < n; i++) {
+      dst[i] = func(src[i]);
+    }
+  }
+}
+
+PixelShader PixelShader::paletteRemap(std::span<const std::pair<Uint32, Uint32>> colors) {
+  PixelShader shader;
+  if (colors.size() > shader.params.from.size()) {
+    print("Palette remap supports up to", shader.params.from.size(), "colors, got", colors.size());
+    exit(1);
+  }
+
+  shader.name = "remap";
+  for (const auto& [from, to] : colors) {
+    shader.params.from[shader.params.count] = from;
+    shader.params.to[shader.params.count] = to;
+    shader.params.count++;
+    shader.name += hex(from) + hex(to);
+  }
+  shader.span = kernel().paletteRemap;
+  return shader;
+}
@@ -1,9 +1,31 @@
 #pragma once
+#include <array>
+#include <cstddef>
 #include <string>
 #include <functional>
+#include <span>
+#include <utility>
 #include <SDL.h>
 
+// constants for the span kernels
+struct ShaderParams {
+    int count = 0;
+    std::array<Uint32, 16> from = {};
+    std::array<Uint32, 16> to = {};
+};
+
+// processes n RGBA8888 pixels at once, src and dst may be the same buffer
+using PixelSpan = void (*)(const Uint32* src, Uint32* dst, size_t n, const ShaderParams& params);
+
 struct PixelShader {
-    std::function<Uint32(Uint32)> func;
+    std::function<Uint32(Uint32)> func;  // per pixel, for one-off custom shaders
     std::string name;
+    PixelSpan span = nullptr;  // used instead of func when set
+    ShaderParams params = {};
+
+    void apply(const Uint32* src, Uint32* dst, size_t n) const;
+
+    // exact color replacement, up to 16 entries, backed by the best kernel
+    // the cpu supports
+    static PixelShader paletteRemap(std::span<const std::pair<Uint32, Uint32>> colors);
 };
@@ -0,0 +1,31 @@
+#include "SpriteBatch.h"
+
+void SpriteBatch::draw(SDL_Renderer* renderer, const AtlasRegion& region, const SDL_Rect& target, SDL_Color tint) {
+  if (region.page != page) {
+    flush(renderer);
+    page = region.page;
+  }
+
+  const float x0 = static_cast<float>(target.x);
+  const float y0 = static_cast<float>(target.y);
+  const float x1 = static_cast<float>(target.x + target.w);
+  const float y1 = static_cast<float>(target.y + target.h);
+
+  const int base = vertices.size();
+  vertices.push_back({ { x0, y0 }, tint, { region.u0, region.v0 } });
+  vertices.push_back({ { x1, y0 }, tint, { region.u1, region.v0 } });
+  vertices.push_back({ { x1, y1 }, tint, { region.u1, region.v1 } });
+  vertices.push_back({ { x0, y1 }, tint, { region.u0, region.v1 } });
+
+  indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+}
+
+void SpriteBatch::flush(SDL_Renderer* renderer) {
+  if (!vertices.empty()) {
+    SDL_RenderGeometry(renderer, page, vertices.data(), vertices.size(), indices.data(), indices.size());
+  }
+
+  vertices.clear();
+  indices.clear();
+  page = nullptr;
+}
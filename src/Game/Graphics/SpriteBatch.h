@@ -0,0 +1,20 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+#include "TextureAtlas.h"
+
+// Collects atlas quads and submits them with one SDL_RenderGeometry call per
+// run of quads sharing a page. Draw order is kept, a page switch flushes.
+class SpriteBatch {
+  public:
+    // the tint modulates the texels, white draws them as they are
+    void draw(SDL_Renderer* renderer, const AtlasRegion& region, const SDL_Rect& target, SDL_Color tint = { 255, 255, 255, 255 });
+    void flush(SDL_Renderer* renderer);
+
+  private:
+    SDL_Texture* page = nullptr;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
@@ -1,5 +1,7 @@
 #include <iostream>
+#include <unordered_map>
 #include "Texture.h"
+#include "Game/AssetArchive.h"
 
 Texture::Texture(SDL_Renderer* renderer) 
   : renderer(renderer) {
@@ -26,45 +28,94 @@ Texture::~Texture() {
   pitch = 0;
 }
 
-void Texture::load(std::string path, PixelShader shader) {
-  if (texture != nullptr) {
-    SDL_DestroyTexture(texture);
-    texture = nullptr;
+SDL_Surface* Texture::decode(const std::string& path, const PixelShader& shader) {
+	SDL_Surface* loadedSurface = IMG_Load_RW(AssetArchive::OpenRW(path), 1);
+
+  if (loadedSurface == nullptr) {
+    std::cerr << "Failed to load image " << path << ": " << IMG_GetError() << std::endl;
+    exit(1);
   }
 
-	SDL_Texture* newTexture = nullptr;
-	SDL_Surface* loadedSurface = IMG_Load(path.c_str());
+  SDL_Surface* formattedSurface = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA8888, 0);
+  SDL_FreeSurface(loadedSurface);
+
+  // the rows are contiguous, so the whole surface is a single span
+  Uint32* pixels = reinterpret_cast<Uint32*>(formattedSurface->pixels);
+  shader.apply(pixels, pixels, formattedSurface->pitch / 4 * formattedSurface->h);
+
+  return formattedSurface;
+}
+
+SDL_Surface* Texture::decodeIndexed(const std::string& path) {
+	SDL_Surface* loadedSurface = IMG_Load_RW(AssetArchive::OpenRW(path), 1);
 
   if (loadedSurface == nullptr) {
     std::cerr << "Failed to load image " << path << ": " << IMG_GetError() << std::endl;
     exit(1);
   }
 
-  SDL_Surface* formattedSurface = SDL_ConvertSurfaceFormat(loadedSurface, format, 0);
-  newTexture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, loadedSurface->w, loadedSurface->h);
-  SDL_SetTextureBlendMode(newTexture, SDL_BLENDMODE_BLEND);
-
-  Uint32* targetPixels;
-  SDL_LockTexture(newTexture, NULL, reinterpret_cast<void**>(&targetPixels), &pitch);
+  if (loadedSurface->format->BitsPerPixel == 8 && loadedSurface->format->palette != nullptr) {
+    // a single transparent palette entry comes back as a color key
+    Uint32 key;
+    if (SDL_GetColorKey(loadedSurface, &key) == 0 && key < 256) {
+      loadedSurface->format->palette->colors[key].a = 0;
+      SDL_SetColorKey(loadedSurface, SDL_FALSE, 0);
+    }
+    return loadedSurface;
+  }
 
-  Uint32* sourcePixels = reinterpret_cast<Uint32*>(formattedSurface->pixels);
+  SDL_Surface* rgba = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA8888, 0);
+  SDL_FreeSurface(loadedSurface);
 
-  if (shader.func != nullptr) {
-    for (int i = 0; i < (pitch/4 * formattedSurface->h); ++i) {
-        targetPixels[i] = shader.func(sourcePixels[i]);
+  SDL_Surface* indexed = SDL_CreateRGBSurfaceWithFormat(0, rgba->w, rgba->h, 8, SDL_PIXELFORMAT_INDEX8);
+  SDL_Color colors[256];
+  std::unordered_map<Uint32, Uint8> lookup;
+
+  for (int y = 0; y < rgba->h; y++) {
+    const Uint32* src = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(rgba->pixels) + y * rgba->pitch);
+    Uint8* dst = static_cast<Uint8*>(indexed->pixels) + y * indexed->pitch;
+
+    for (int x = 0; x < rgba->w; x++) {
+      auto it = lookup.find(src[x]);
+      if (it == lookup.end()) {
+        if (lookup.size() == 256) {
+          std::cerr << "Image " << path << " has more than 256 colors, it can't be indexed" << std::endl;
+          exit(1);
+        }
+
+        Uint8 index = lookup.size();
+        colors[index] = { Uint8(src[x] >> 24), Uint8(src[x] >> 16), Uint8(src[x] >> 8), Uint8(src[x]) };
+        it = lookup.emplace(src[x], index).first;
+      }
+      dst[x] = it->second;
     }
-  } else {
-    memcpy(targetPixels, sourcePixels, pitch * formattedSurface->h);
   }
-  
-  SDL_UnlockTexture(newTexture);
 
-  width = loadedSurface->w;
-  height = loadedSurface->h;
-  
+  SDL_SetPaletteColors(indexed->format->palette, colors, 0, lookup.size());
+  SDL_FreeSurface(rgba);
+
+  return indexed;
+}
+
+void Texture::load(std::string path, PixelShader shader) {
+  SDL_Surface* formattedSurface = decode(path, shader);
+  upload(formattedSurface);
   SDL_FreeSurface(formattedSurface);
-  SDL_FreeSurface(loadedSurface);
-  
+}
+
+void Texture::upload(const SDL_Surface* surface) {
+  if (texture != nullptr) {
+    SDL_DestroyTexture(texture);
+    texture = nullptr;
+  }
+
+	SDL_Texture* newTexture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, surface->w, surface->h);
+  SDL_SetTextureBlendMode(newTexture, SDL_BLENDMODE_BLEND);
+  SDL_UpdateTexture(newTexture, NULL, surface->pixels, surface->pitch);
+
+  width = surface->w;
+  height = surface->h;
+
 	texture = newTexture;
 }
 
@@ -72,6 +123,10 @@ Uint32 Texture::color(Uint8 red, Uint8 green, Uint8 blue) {
   return SDL_MapRGB(mappingFormat, red, green, blue);
 }
 
+void Texture::setColorMod(SDL_Color color) {
+  SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+}
+
 void Texture::render(int x, int y, int w, int h, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip) {
   int rWidth = width;
   int rHeight = height;
@@ -14,9 +14,20 @@ class Texture {
 
 		void load(std::string path, PixelShader shader = { nullptr, "" });
 
+		// decodes an image into a RGBA8888 surface with the shader applied,
+		// the caller owns the surface
+		static SDL_Surface* decode(const std::string& path, const PixelShader& shader = { nullptr, "" });
+		// decodes an image into an 8 bit INDEX8 surface whose palette carries
+		// alpha, true color images are indexed if they use 256 colors or less
+		static SDL_Surface* decodeIndexed(const std::string& path);
+		// creates the texture from an already decoded surface, render thread only
+		void upload(const SDL_Surface* surface);
+		bool isLoaded() const { return texture != nullptr; }
+
 		void render(int x, int y, int w = 0, int h = 0, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE);
 
 		Uint32 color(Uint8 red, Uint8 green, Uint8 blue);
+		void setColorMod(SDL_Color color);
 
 		bool lockTexture();
 		bool unlockTexture();
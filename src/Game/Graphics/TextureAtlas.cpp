@@ -0,0 +1,221 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <print.h>
+
+// empty pixels between frames so scaled sampling never bleeds into a neighbour
+static const int PADDING = 1;
+
+const AtlasRegion* AtlasSprite::frame(int xIndex, int yIndex) const {
+  if (xIndex < 0 || yIndex < 0 || xIndex >= columns || yIndex >= rows) {
+    return nullptr;
+  }
+
+  size_t index = yIndex * columns + xIndex;
+  if (index >= frames.size() || frames[index].page == nullptr) {
+    return nullptr;
+  }
+
+  return &frames[index];
+}
+
+TextureAtlas::TextureAtlas(SDL_Renderer* renderer, int maxPageSize)
+  : renderer(renderer), pageSize(maxPageSize) {
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(renderer, &info) == 0) {
+    if (info.max_texture_width > 0) {
+      pageSize = std::min(pageSize, info.max_texture_width);
+    }
+    if (info.max_texture_height > 0) {
+      pageSize = std::min(pageSize, info.max_texture_height);
+    }
+  }
+}
+
+TextureAtlas::~TextureAtlas() {
+  for (auto& page : pages) {
+    if (page.surface) {
+      SDL_FreeSurface(page.surface);
+    }
+    if (page.texture) {
+      SDL_DestroyTexture(page.texture);
+    }
+  }
+}
+
+AtlasSprite* TextureAtlas::add(const std::string& key, std::shared_ptr<DecodeJob> sheet, int w, int h) {
+  if (state != State::Decoding) {
+    print("Sprite added to an atlas that is already built:", key);
+    exit(1);
+  }
+
+  auto sprite = std::make_unique<AtlasSprite>();
+  AtlasSprite* result = sprite.get();
+  sprites[key] = std::move(sprite);
+  sheets.push_back({ result, std::move(sheet), w, h });
+
+  return result;
+}
+
+AtlasSprite* TextureAtlas::find(const std::string& key) {
+  auto it = sprites.find(key);
+  return it != sprites.end() ? it->second.get() : nullptr;
+}
+
+bool TextureAtlas::place(Page& page, int w, int h, SDL_Rect& rect) {
+  // shelf packing: fill rows left to right, open a new row below when full
+  if (page.shelfX + w + PADDING > pageSize) {
+    page.shelfY += page.shelfHeight;
+    page.shelfX = 0;
+    page.shelfHeight = 0;
+  }
+
+  if (page.shelfY + h + PADDING > pageSize) {
+    return false;
+  }
+
+  rect = { page.shelfX, page.shelfY, w, h };
+  page.shelfX += w + PADDING;
+  page.shelfHeight = std::max(page.shelfHeight, h + PADDING);
+
+  return true;
+}
+
+void TextureAtlas::pack() {
+  for (auto& sheet : sheets) {
+    const SDL_Surface* surface = sheet.job->surface;
+    sheet.w = sheet.w > 0 ? sheet.w : surface->w;
+    sheet.h = sheet.h > 0 ? sheet.h : surface->h;
+    sheet.columns = surface->w / sheet.w;
+    sheet.rows = surface->h / sheet.h;
+
+    if (sheet.w + PADDING > pageSize || sheet.h + PADDING > pageSize) {
+      print("Sprite frame doesn't fit in an atlas page:", sheet.w, sheet.h);
+      exit(1);
+    }
+  }
+
+  // tallest frames first, so the shelves waste less space
+  std::stable_sort(sheets.begin(), sheets.end(), [](const Sheet& a, const Sheet& b) {
+    return a.h > b.h;
+  });
+
+  for (auto& sheet : sheets) {
+    // decoded surfaces may be shared with other atlases, so copy rows by hand
+    // instead of SDL_BlitSurface, which caches its blit map on the source
+    const SDL_Surface* surface = sheet.job->surface;
+
+    for (int row = 0; row < sheet.rows; row++) {
+      for (int column = 0; column < sheet.columns; column++) {
+        SDL_Rect rect;
+        if (pages.empty() || !place(pages.back(), sheet.w, sheet.h, rect)) {
+          Page page;
+          page.surface = SDL_CreateRGBSurfaceWithFormat(0, pageSize, pageSize, 32, SDL_PIXELFORMAT_RGBA8888);
+          SDL_memset(page.surface->pixels, 0, page.surface->pitch * page.surface->h);
+          pages.push_back(page);
+          place(pages.back(), sheet.w, sheet.h, rect);
+        }
+
+        SDL_Surface* target = pages.back().surface;
+        const Uint8* src = static_cast<const Uint8*>(surface->pixels) + row * sheet.h * surface->pitch + column * sheet.w * 4;
+        Uint8* dst = static_cast<Uint8*>(target->pixels) + rect.y * target->pitch + rect.x * 4;
+        for (int y = 0; y < sheet.h; y++) {
+          SDL_memcpy(dst + y * target->pitch, src + y * surface->pitch, sheet.w * 4);
+        }
+
+        sheet.placed.push_back({ rect, pages.size() - 1 });
+      }
+    }
+
+    // the pixels live in the page now
+    sheet.job.reset();
+  }
+
+  for (auto& page : pages) {
+    // the last shelf rarely reaches the bottom, don't upload the empty rows
+    page.height = std::min(pageSize, page.shelfY + page.shelfHeight);
+  }
+
+  packed = true;
+}
+
+bool TextureAtlas::upload() {
+  switch (state) {
+    case State::Decoding:
+      for (const auto& sheet : sheets) {
+        if (!sheet.job->ready) {
+          return false;
+        }
+      }
+      state = State::Packing;
+      // the worker keeps the atlas alive even if the scene goes away meanwhile
+      TextureLoader::Background([self = shared_from_this()] { self->pack(); });
+      return false;
+
+    case State::Packing:
+      if (!packed) {
+        return false;
+      }
+      state = State::Uploading;
+      [[fallthrough]];
+
+    case State::Uploading:
+      // one page per step keeps a big atlas from eating a whole frame
+      if (uploadedPages < pages.size()) {
+        Page& page = pages[uploadedPages++];
+        page.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, pageSize, page.height);
+        SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+        SDL_UpdateTexture(page.texture, NULL, page.surface->pixels, page.surface->pitch);
+
+        SDL_FreeSurface(page.surface);
+        page.surface = nullptr;
+        return false;
+      }
+
+      resolve();
+      state = State::Ready;
+      print("Atlas built with", pages.size(), "pages of", pageSize);
+      return true;
+
+    case State::Ready:
+      return true;
+  }
+
+  return true;
+}
+
+void TextureAtlas::resolve() {
+  for (auto& sheet : sheets) {
+    AtlasSprite* sprite = sheet.sprite;
+    sprite->w = sheet.w;
+    sprite->h = sheet.h;
+    sprite->frames.resize(sheet.columns * sheet.rows);
+
+    for (size_t i = 0; i < sheet.placed.size(); i++) {
+      const auto& [rect, pageIndex] = sheet.placed[i];
+      const Page& page = pages[pageIndex];
+
+      AtlasRegion& region = sprite->frames[i];
+      region.page = page.texture;
+      region.rect = rect;
+      region.u0 = static_cast<float>(rect.x) / pageSize;
+      region.v0 = static_cast<float>(rect.y) / page.height;
+      region.u1 = static_cast<float>(rect.x + rect.w) / pageSize;
+      region.v1 = static_cast<float>(rect.y + rect.h) / page.height;
+    }
+
+    // columns last, frame() checks it before touching the regions
+    sprite->rows = sheet.rows;
+    sprite->columns = sheet.columns;
+  }
+
+  sheets.clear();
+}
+
+bool TextureAtlas::isReady() const {
+  return state == State::Ready;
+}
+
+int TextureAtlas::pageCount() const {
+  return pages.size();
+}
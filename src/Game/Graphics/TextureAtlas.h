@@ -0,0 +1,92 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TextureLoader.h"
+
+struct AtlasRegion {
+  SDL_Texture* page = nullptr;
+  SDL_Rect rect = { 0, 0, 0, 0 };
+  // normalized texture coordinates inside the page
+  float u0 = 0;
+  float v0 = 0;
+  float u1 = 0;
+  float v1 = 0;
+};
+
+// every frame of one sprite sheet, row major
+struct AtlasSprite {
+  int columns = 0;
+  int rows = 0;
+  int w = 0;
+  int h = 0;
+  std::vector<AtlasRegion> frames;
+
+  // nullptr if the frame doesn't exist or the atlas isn't uploaded yet
+  const AtlasRegion* frame(int xIndex, int yIndex) const;
+};
+
+// Packs the frames of many sprite sheets into a few large page textures, so
+// sprites sharing a page can be drawn with a single geometry call.
+//
+// Building is asynchronous: sheets are decoded and packed on worker threads,
+// then the pages are uploaded one per step by the TextureLoader. Until then
+// every sprite resolves no frames and simply isn't drawn.
+class TextureAtlas : public UploadTask, public std::enable_shared_from_this<TextureAtlas> {
+  public:
+    TextureAtlas(SDL_Renderer* renderer, int maxPageSize = 2048);
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // the sheet is cut into w x h frames once it is decoded, 0 is the whole sheet
+    AtlasSprite* add(const std::string& key, std::shared_ptr<DecodeJob> sheet, int w, int h);
+    AtlasSprite* find(const std::string& key);
+
+    // steps the build, call through TextureLoader::Enqueue
+    bool upload() override;
+    bool isReady() const;
+    int pageCount() const;
+
+  private:
+    enum class State { Decoding, Packing, Uploading, Ready };
+
+    struct Sheet {
+      AtlasSprite* sprite;
+      std::shared_ptr<DecodeJob> job;
+      int w;
+      int h;
+      int columns = 0;
+      int rows = 0;
+      // where every frame ended up, filled in by pack()
+      std::vector<std::pair<SDL_Rect, size_t>> placed;
+    };
+
+    struct Page {
+      SDL_Surface* surface = nullptr;
+      SDL_Texture* texture = nullptr;
+      int shelfX = 0;
+      int shelfY = 0;
+      int shelfHeight = 0;
+      int height = 0;  // rows actually uploaded
+    };
+
+    bool place(Page& page, int w, int h, SDL_Rect& rect);
+    // cpu only, runs on a worker and touches nothing the render thread reads
+    void pack();
+    void resolve();
+
+    SDL_Renderer* renderer;
+    int pageSize;
+    State state = State::Decoding;
+    std::atomic<bool> packed = false;
+    size_t uploadedPages = 0;
+    std::vector<Sheet> sheets;
+    std::vector<Page> pages;
+    std::map<std::string, std::unique_ptr<AtlasSprite>> sprites;
+};
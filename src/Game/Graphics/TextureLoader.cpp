@@ -0,0 +1,104 @@
+#include "TextureLoader.h"
+
+#include <string_view>
+
+#include "Texture.h"
+
+tbb::task_group TextureLoader::workers;
+std::unordered_map<TextureLoader::JobKey, std::weak_ptr<DecodeJob>, TextureLoader::JobKeyHash> TextureLoader::jobs;
+std::unordered_map<TextureLoader::JobKey, std::shared_ptr<DecodeJob>, TextureLoader::JobKeyHash> TextureLoader::prefetched;
+std::vector<std::shared_ptr<UploadTask>> TextureLoader::uploads;
+
+DecodeJob::~DecodeJob() {
+  if (surface) {
+    SDL_FreeSurface(surface);
+  }
+}
+
+size_t TextureLoader::JobKeyHash::operator()(const JobKey& key) const {
+  // combined the same way TextureManager keys its slots
+  size_t seed = std::hash<std::string_view>{}(key.path);
+  seed ^= std::hash<std::string_view>{}(key.shaderName) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  return seed;
+}
+
+std::shared_ptr<DecodeJob> TextureLoader::Start(JobKey key, std::function<SDL_Surface*()> decode) {
+  auto it = jobs.find(key);
+  if (it != jobs.end()) {
+    if (auto job = it->second.lock()) {
+      return job;
+    }
+  }
+
+  // jobs nobody holds anymore would pile up over a session, drop them
+  std::erase_if(jobs, [](const auto& entry) { return entry.second.expired(); });
+
+  auto job = std::make_shared<DecodeJob>();
+  jobs[std::move(key)] = job;
+
+  workers.run([job, decode = std::move(decode)] {
+    job->surface = decode();
+    job->ready = true;
+  });
+
+  return job;
+}
+
+std::shared_ptr<DecodeJob> TextureLoader::Decode(const std::string& path, const PixelShader& shader) {
+  JobKey key = { path, shader.name };
+  auto job = Start(key, [path, shader] { return Texture::decode(path, shader); });
+
+  // whoever asked now owns it, the surface goes when they're done with it
+  prefetched.erase(key);
+  return job;
+}
+
+std::shared_ptr<DecodeJob> TextureLoader::DecodeIndexed(const std::string& path) {
+  return Start({ path, "#indexed" }, [path] { return Texture::decodeIndexed(path); });
+}
+
+void TextureLoader::Prefetch(const std::string& path, const PixelShader& shader) {
+  auto job = Decode(path, shader);
+  prefetched[{ path, shader.name }] = std::move(job);
+}
+
+void TextureLoader::Background(std::function<void()> work) {
+  workers.run(std::move(work));
+}
+
+void TextureLoader::Enqueue(std::shared_ptr<UploadTask> task) {
+  uploads.push_back(std::move(task));
+}
+
+bool TextureLoader::Upload(double budgetMillis) {
+  Uint64 start = SDL_GetPerformanceCounter();
+  Uint64 budget = static_cast<Uint64>(budgetMillis / 1000.0 * SDL_GetPerformanceFrequency());
+  bool finished = false;
+
+  for (auto it = uploads.begin(); it != uploads.end();) {
+    if (SDL_GetPerformanceCounter() - start > budget) {
+      break;
+    }
+
+    // whoever asked for it is gone, don't bother
+    if (it->use_count() == 1) {
+      it = uploads.erase(it);
+      continue;
+    }
+
+    if ((*it)->upload()) {
+      finished = true;
+      it = uploads.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  return finished;
+}
+
+void TextureLoader::tearDown() {
+  workers.wait();
+  uploads.clear();
+  prefetched.clear();
+}
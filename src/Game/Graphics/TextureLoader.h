@@ -0,0 +1,68 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <tbb/task_group.h>
+#include "PixelShader.h"
+
+// an image decoded on a worker thread. once ready the surface is RGBA8888
+// with the shader applied, and is only ever read, from any thread
+struct DecodeJob {
+  std::atomic<bool> ready = false;
+  SDL_Surface* surface = nullptr;
+  ~DecodeJob();
+};
+
+// work that must happen on the render thread, done a bounded step at a time
+class UploadTask {
+  public:
+    virtual ~UploadTask() = default;
+    // true when the task is finished
+    virtual bool upload() = 0;
+};
+
+class TextureLoader {
+  public:
+    // starts decoding on a worker thread, requests for the same path and
+    // shader share a job while somebody holds on to it
+    static std::shared_ptr<DecodeJob> Decode(const std::string& path, const PixelShader& shader = {nullptr, ""});
+    // same, but the surface is INDEX8, see Texture::decodeIndexed
+    static std::shared_ptr<DecodeJob> DecodeIndexed(const std::string& path);
+    // decodes for a scene that isn't set up yet. the loader holds the job
+    // until the next Decode of the same path and shader takes it over
+    static void Prefetch(const std::string& path, const PixelShader& shader = {nullptr, ""});
+    // cpu work that doesn't need the renderer (atlas packing)
+    static void Background(std::function<void()> work);
+
+    static void Enqueue(std::shared_ptr<UploadTask> task);
+    // steps queued uploads until the budget is spent, true if any finished
+    static bool Upload(double budgetMillis);
+
+    static void tearDown();
+
+  private:
+    // path and shader name kept apart, concatenated "ab" + "c" and "a" + "bc"
+    // would be the same job
+    struct JobKey {
+      std::string path;
+      std::string shaderName;
+
+      bool operator==(const JobKey& other) const = default;
+    };
+
+    struct JobKeyHash {
+      size_t operator()(const JobKey& key) const;
+    };
+
+    static std::shared_ptr<DecodeJob> Start(JobKey key, std::function<SDL_Surface*()> decode);
+
+    static tbb::task_group workers;
+    static std::unordered_map<JobKey, std::weak_ptr<DecodeJob>, JobKeyHash> jobs;
+    static std::unordered_map<JobKey, std::shared_ptr<DecodeJob>, JobKeyHash> prefetched;
+    static std::vector<std::shared_ptr<UploadTask>> uploads;
+};
@@ -1,32 +1,105 @@
 #include "TextureManager.h"
+#include <functional>
 #include <iostream>
 #include <print.h>
 
-std::map<std::string, Texture*> TextureManager::textures;
+// uploads the decoded indices once the worker is done
+struct TextureManager::PendingIndexedTexture : UploadTask {
+    IndexedTexture* texture;
+    std::shared_ptr<DecodeJob> job;
 
-Texture* TextureManager::LoadTexture(const std::string& fileName, SDL_Renderer* renderer, PixelShader shader) {
-    if (textures.count(fileName + shader.name) > 0) {
-        return textures[fileName + shader.name];
+    PendingIndexedTexture(IndexedTexture* texture, std::shared_ptr<DecodeJob> job)
+        : texture(texture), job(std::move(job)) { }
+
+    bool upload() override {
+        if (!job->ready) {
+            return false;
+        }
+
+        texture->upload(job->surface);
+        job.reset();
+        return true;
+    }
+};
+
+std::vector<TextureManager::Slot> TextureManager::slots;
+std::vector<uint32_t> TextureManager::freeSlots;
+std::unordered_map<std::string, uint32_t> TextureManager::lookup;
+
+uint32_t TextureManager::allocateSlot(const std::string& fileName) {
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = slots.size();
+        slots.emplace_back();
     }
-    
-    Texture* tex = new Texture(renderer);
-    tex->load("assets/" + fileName, shader);
-    
-    textures[fileName + shader.name] = tex;    
-    return tex;
+
+    Slot& slot = slots[index];
+    slot.refCount = 1;
+    slot.fileName = fileName;
+
+    lookup[fileName] = index;
+    return index;
 }
 
-void TextureManager::UnloadTexture(const std::string& fileName, const std::string& shaderName) {
-    if (textures.count(fileName + shaderName) > 0) {
-        delete textures[fileName + shaderName];
-        textures.erase(fileName + shaderName);
+TextureHandle TextureManager::LoadIndexedTexture(const std::string& fileName, SDL_Renderer* renderer, PixelShader shader) {
+    auto existing = lookup.find(fileName);
+    if (existing != lookup.end()) {
+        Slot& slot = slots[existing->second];
+        slot.refCount++;
+        return { existing->second, slot.generation, uint32_t(slot.indexed->addPalette(shader)) };
     }
+
+    uint32_t index = allocateSlot(fileName);
+    IndexedTexture* tex = new IndexedTexture(renderer);
+
+    Slot& slot = slots[index];
+    slot.indexed = tex;
+    slot.pending = std::make_shared<PendingIndexedTexture>(tex, TextureLoader::DecodeIndexed("assets/" + fileName));
+    TextureLoader::Enqueue(slot.pending);
+
+    return { index, slot.generation, uint32_t(tex->addPalette(shader)) };
 }
 
-Texture* TextureManager::GetTexture(const std::string& fileName, const std::string& shaderName) {
-    if(textures.count(fileName + shaderName) > 0) {
-        return textures[fileName + shaderName];
+void TextureManager::UnloadTexture(TextureHandle handle) {
+    if (handle.index >= slots.size()) {
+        return;
+    }
+
+    Slot& slot = slots[handle.index];
+    if (slot.generation != handle.generation || slot.refCount == 0) {
+        return;  // stale handle, already freed
     }
-    
-    return nullptr;
+
+    if (--slot.refCount > 0) {
+        return;  // another scene still uses it
+    }
+
+    // the loader sees nobody holds the upload anymore and skips it
+    slot.pending.reset();
+    delete slot.indexed;
+    slot.indexed = nullptr;
+    lookup.erase(slot.fileName);
+
+    // bump the generation so old handles to this slot stop resolving
+    slot.generation++;
+    if (slot.generation == 0) {
+        slot.generation = 1;
+    }
+    freeSlots.push_back(handle.index);
+}
+
+IndexedTexture* TextureManager::GetIndexedTexture(TextureHandle handle) {
+    if (handle.index >= slots.size()) {
+        return nullptr;
+    }
+
+    const Slot& slot = slots[handle.index];
+    if (slot.generation != handle.generation || slot.indexed == nullptr || !slot.indexed->isLoaded()) {
+        return nullptr;
+    }
+
+    return slot.indexed;
 }
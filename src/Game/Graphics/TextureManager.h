@@ -1,14 +1,51 @@
 #pragma once
-#include "Texture.h"
+#include "IndexedTexture.h"
 #include "PixelShader.h"
-#include <map>
+#include "TextureLoader.h"
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+// index into the texture slots, the generation makes handles to a slot that
+// was freed and reused invalid instead of pointing at someone else's texture
+struct TextureHandle {
+  uint32_t index = 0;
+  uint32_t generation = 0;  // 0 is never a live generation
+  uint32_t palette = 0;  // variant of an indexed texture
+
+  explicit operator bool() const { return generation != 0; }
+  bool operator==(const TextureHandle& other) const = default;
+};
 
 class TextureManager {
   public:
-    static Texture* LoadTexture(const std::string& fileName, SDL_Renderer* renderer, PixelShader shader = {nullptr, ""});
-    static void UnloadTexture(const std::string& fileName, const std::string& shaderName = "");
-    static Texture* GetTexture(const std::string& fileName, const std::string& shaderName = "");
+    // one indexed image per file, every shader adds a palette variant to it
+    // instead of another texture. starts loading it, or adds a reference if
+    // it is already loaded. the handle is valid right away, the pixels
+    // arrive later. render with the handle's palette
+    static TextureHandle LoadIndexedTexture(const std::string& fileName, SDL_Renderer* renderer, PixelShader shader = {nullptr, ""});
+    // drops a reference, the texture is freed when nobody uses it anymore
+    static void UnloadTexture(TextureHandle handle);
+    // nullptr if the handle is stale or the texture isn't uploaded yet
+    static IndexedTexture* GetIndexedTexture(TextureHandle handle);
+
   private:
-    static std::map<std::string, Texture*> textures;
+    struct PendingIndexedTexture;
+
+    struct Slot {
+      IndexedTexture* indexed = nullptr;
+      std::shared_ptr<UploadTask> pending;  // dropping it cancels the upload
+      uint32_t generation = 1;
+      uint32_t refCount = 0;
+      std::string fileName;
+    };
+
+    static uint32_t allocateSlot(const std::string& fileName);
+
+    static std::vector<Slot> slots;
+    static std::vector<uint32_t> freeSlots;
+    // the variants share the slot, so a file has one
+    static std::unordered_map<std::string, uint32_t> lookup;
 };
@@ -0,0 +1,196 @@
+#include "Startup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <print.h>
+#include <tbb/concurrent_queue.h>
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+
+void StartupGraph::add(const std::string& name, std::vector<std::string> after, std::function<void()> work, bool mainThread) {
+  tasks.push_back({ name, std::move(after), std::move(work), mainThread });
+}
+
+void StartupGraph::run() {
+  const size_t count = tasks.size();
+  std::vector<std::vector<size_t>> dependents(count);
+  auto pending = std::make_unique<std::atomic<size_t>[]>(count);
+
+  for (size_t i = 0; i < count; i++) {
+    pending[i] = tasks[i].after.size();
+
+    for (const std::string& name : tasks[i].after) {
+      auto it = std::find_if(tasks.begin(), tasks.end(), [&name](const Task& task) { return task.name == name; });
+      if (it == tasks.end()) {
+        print("Startup task", tasks[i].name, "comes after unknown task", name);
+        exit(1);
+      }
+      dependents[it - tasks.begin()].push_back(i);
+    }
+  }
+
+  // a cycle would wait forever, so check there's an order that works
+  {
+    std::vector<size_t> remaining(count);
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < count; i++) {
+      remaining[i] = pending[i];
+      if (remaining[i] == 0) {
+        ready.push_back(i);
+      }
+    }
+
+    size_t ordered = 0;
+    while (!ready.empty()) {
+      size_t i = ready.back();
+      ready.pop_back();
+      ordered++;
+      for (size_t d : dependents[i]) {
+        if (--remaining[d] == 0) {
+          ready.push_back(d);
+        }
+      }
+    }
+
+    if (ordered != count) {
+      print("Startup tasks depend on each other in a cycle");
+      exit(1);
+    }
+  }
+
+  std::atomic<size_t> unfinished = count;
+  tbb::concurrent_queue<size_t> mainQueue;
+  tbb::task_group workers;
+
+  // wakes the main thread when it has a task or everything is done. taking
+  // the lock before notifying makes sure it is either still checking, and
+  // sees the change, or already waiting
+  std::mutex wakeMutex;
+  std::condition_variable wake;
+  auto signal = [&] {
+    { std::lock_guard<std::mutex> lock(wakeMutex); }
+    wake.notify_one();
+  };
+
+  // the first exception a task throws. the tasks after it are still counted
+  // off so nothing waits forever, but their work is skipped
+  std::mutex failureMutex;
+  std::exception_ptr failure;
+  std::atomic<bool> failed = false;
+
+  std::function<void(size_t)> launch;
+
+  auto execute = [&](size_t i) {
+    if (failed) {
+      return;
+    }
+
+    try {
+      Uint64 start = SDL_GetPerformanceCounter();
+      tasks[i].work();
+      StartupTimeline::Record(tasks[i].name, start, SDL_GetPerformanceCounter());
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(failureMutex);
+      if (!failure) {
+        failure = std::current_exception();
+        failed = true;
+      }
+    }
+  };
+
+  auto finish = [&](size_t i) {
+    for (size_t d : dependents[i]) {
+      if (--pending[d] == 0) {
+        launch(d);
+      }
+    }
+    if (--unfinished == 0) {
+      signal();
+    }
+  };
+
+  launch = [&](size_t i) {
+    if (tasks[i].mainThread) {
+      mainQueue.push(i);
+      signal();
+    } else {
+      workers.run([&, i] {
+        execute(i);
+        finish(i);
+      });
+    }
+  };
+
+  for (size_t i = 0; i < count; i++) {
+    if (tasks[i].after.empty()) {
+      launch(i);
+    }
+  }
+
+  // main thread tasks are handed to us as their dependencies finish, we
+  // sleep until the next one comes in. with a single core there are no
+  // worker threads, the pool only makes progress inside wait() then
+  const bool hasWorkers = tbb::this_task_arena::max_concurrency() > 1
+    && tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism) > 1;
+
+  while (unfinished > 0) {
+    size_t i;
+    if (mainQueue.try_pop(i)) {
+      execute(i);
+      finish(i);
+    } else if (!hasWorkers) {
+      workers.wait();
+    } else {
+      std::unique_lock<std::mutex> lock(wakeMutex);
+      wake.wait(lock, [&] { return !mainQueue.empty() || unfinished == 0; });
+    }
+  }
+
+  workers.wait();
+  tasks.clear();
+
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+Uint64 StartupTimeline::origin = SDL_GetPerformanceCounter();
+bool StartupTimeline::reported = false;
+std::mutex StartupTimeline::mutex;
+std::vector<StartupTimeline::Span> StartupTimeline::spans;
+
+double StartupTimeline::millis(Uint64 counter) {
+  return (counter - origin) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+void StartupTimeline::Record(const std::string& name, Uint64 start, Uint64 end) {
+  std::lock_guard<std::mutex> lock(mutex);
+  spans.push_back({ name, millis(start), millis(end) });
+}
+
+void StartupTimeline::Mark(const std::string& name) {
+  Uint64 now = SDL_GetPerformanceCounter();
+  Record(name, now, now);
+}
+
+void StartupTimeline::Report() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (reported) {
+    return;
+  }
+  reported = true;
+
+  std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) {
+    return a.start < b.start;
+  });
+
+  print("Startup timeline (ms)");
+  for (const Span& span : spans) {
+    std::printf("  %8.1f %8.1f  %s\n", span.start, span.end, span.name.c_str());
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Work that has to happen before the first frame, as a small dependency
+// graph. A task starts as soon as the tasks it comes after are done, tasks
+// that don't depend on each other run at the same time on the TBB pool.
+// Tasks that need the main thread (window, renderer, anything touching the
+// scenes) run on the thread that calls run().
+class StartupGraph {
+  public:
+    void add(const std::string& name, std::vector<std::string> after, std::function<void()> work, bool mainThread = false);
+    // blocks until every task is done. if a task throws, the tasks that
+    // haven't started are skipped and the exception is rethrown here once
+    // the running ones are done
+    void run();
+
+  private:
+    struct Task {
+      std::string name;
+      std::vector<std::string> after;
+      std::function<void()> work;
+      bool mainThread;
+    };
+
+    std::vector<Task> tasks;
+};
+
+// What ran when during startup, in milliseconds since the process started.
+// Printed once the first frame is on screen.
+class StartupTimeline {
+  public:
+    static void Record(const std::string& name, Uint64 start, Uint64 end);
+    static void Mark(const std::string& name);
+    static void Report();
+
+  private:
+    struct Span {
+      std::string name;
+      double start;
+      double end;
+    };
+
+    static double millis(Uint64 counter);
+
+    static Uint64 origin;
+    static bool reported;
+    static std::mutex mutex;
+    static std::vector<Span> spans;
+};
@@ -2,12 +2,14 @@
 
 #include <string>
 #include <print.h>
-#include <tbb/task_group.h>
 
 tbb::concurrent_queue<std::string> AiManager::requestQueue;
 tbb::concurrent_queue<std::string> AiManager::responseQueue;
 Base* AiManager::model = nullptr;
-tbb::task_group AiManager::taskGroup;
+// one slot and none kept for the caller, so a worker runs the tasks one at
+// a time and enqueue never blocks
+tbb::task_arena AiManager::arena(1, 0);
+std::atomic<size_t> AiManager::pending = 0;
 std::string AiManager::antiprompt;
 
 void AiManager::setUp(
@@ -32,7 +34,7 @@ void AiManager::setUp(
   }
   antiprompt = userLabel + " ";
 
-  taskGroup.run([] {
+  submit([] {
     // this is extremely slow, minutes even
     model->initialize();
 
@@ -45,7 +47,7 @@ void AiManager::run() {
   if (model != nullptr && model->isInitialized) {
     std::string prompt;
     if (requestQueue.try_pop(prompt)) {
-      taskGroup.run([prompt] { 
+      submit([prompt] { 
         // we process user input first, this consumes one item 
         model->process(prompt); 
 
@@ -59,8 +61,8 @@ void AiManager::run() {
 void AiManager::retrain(const std::string promptFile) {
   /* print("retrain with", promptFile); */
   if (model != nullptr && model->isInitialized) {
-    taskGroup.wait();
-    taskGroup.run([promptFile] { 
+    wait();
+    submit([promptFile] { 
       // we process user input first, this consumes one item 
       model->retrain(promptFile); 
 
@@ -71,7 +73,22 @@ void AiManager::retrain(const std::string promptFile) {
 }
 
 void AiManager::tearDown() {
-  taskGroup.wait();
+  wait();
+}
+
+void AiManager::submit(std::function<void()> work) {
+  pending++;
+  arena.enqueue([work = std::move(work)] {
+    work();
+    pending--;
+    pending.notify_all();
+  });
+}
+
+void AiManager::wait() {
+  for (size_t n = pending; n > 0; n = pending) {
+    pending.wait(n);
+  }
 }
 
 bool AiManager::endsWithAntiPrompt(const std::string& str) {
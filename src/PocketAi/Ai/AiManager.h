@@ -3,10 +3,11 @@
 #include "Baka.h"
 #include "Llama.h"
 
-#include <oneapi/tbb/task_group.h>
+#include <atomic>
+#include <functional>
 #include <string>
 #include <tbb/concurrent_queue.h>
-#include <tbb/task_group.h>
+#include <tbb/task_arena.h>
 
 enum Smarts {
   BAKA,
@@ -30,5 +31,10 @@ public:
 private:
   static std::string antiprompt; 
   static Base* model;
-  static tbb::task_group taskGroup;
+  // model work runs in its own arena, a thread waiting on the frame's
+  // update systems can't steal an inference from there
+  static tbb::task_arena arena;
+  static std::atomic<size_t> pending;
+  static void submit(std::function<void()> work);
+  static void wait();
 };
@@ -4,8 +4,10 @@
 #include <thread>
 #include <chrono>
 #include <regex>
+#include <sstream>
 #include <print.h>
 #include "AiManager.h"
+#include "Game/AssetArchive.h"
 
 Baka::Baka(
   const std::string& username,
@@ -59,13 +61,10 @@ void Baka::retrain(const std::string& promptFile) {
 }
 
 void Baka::loadPrompts(std::string promptFile) {
-  std::ifstream file("assets/Prompts/" + promptFile);
-  if (file.is_open()) {
-    std::string line;
-    while (getline(file, line)) {
-      prompts.push_back(line);
-    }
-    file.close();
+  std::istringstream file(AssetArchive::ReadText("assets/Prompts/" + promptFile));
+  std::string line;
+  while (getline(file, line)) {
+    prompts.push_back(line);
   }
 }
 
@@ -1,5 +1,6 @@
 #include "Llama.h"
 #include "PocketAi/Ai/AiManager.h"
+#include "Game/AssetArchive.h"
 #include "log.h"
 #include <SDL_timer.h>
 #include <print.h>
@@ -15,10 +16,7 @@
 #include <chrono>
 
 std::string readFromFile(const std::string& filename) {
-  std::ifstream inFile(filename);
-  std::stringstream buffer;
-  buffer << inFile.rdbuf();
-  return buffer.str();
+  return AssetArchive::ReadText(filename);
 }
 
 Llama::Llama(
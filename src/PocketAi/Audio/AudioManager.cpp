@@ -1,38 +1,295 @@
 #include <print.h>
+#include <filesystem>
 #include "AudioManager.h"
+#include "Game/AssetArchive.h"
 
 // Initialize static members
 FMOD::System* AudioManager::system = nullptr;
-FMOD::Sound* AudioManager::sound = nullptr;
-FMOD::Channel* AudioManager::channel = 0;
+std::unordered_map<std::string, FMOD::Sound*> AudioManager::streams;
+std::string AudioManager::current;
+FMOD::Channel* AudioManager::channel = nullptr;
+std::string AudioManager::fading;
+FMOD::Channel* AudioManager::fadingChannel = nullptr;
+std::string AudioManager::pending;
+float AudioManager::pendingFade = 0.0f;
 FMOD_RESULT AudioManager::result;
+std::unordered_map<SampleId, FMOD::Sound*> AudioManager::samples;
+std::array<AudioManager::Voice, 8> AudioManager::voices;
+unsigned int AudioManager::voiceCount = 0;
+std::mutex AudioManager::samplesMutex;
+std::mutex AudioManager::initMutex;
 
 
 
 void AudioManager::Init() {
+    // startup runs it on a worker while scenes may already ask for sounds
+    std::lock_guard<std::mutex> lock(initMutex);
+    if (system != nullptr) {
+        return;
+    }
+
     FMOD::System_Create(&system);
     result = system->init(32, FMOD_INIT_NORMAL, 0);
 }
 
-void AudioManager::PlaySong(const std::string& filePath) {
-    if (sound != nullptr) {
-        sound->release();
-        sound = nullptr;
+std::string AudioManager::resolve(const std::string& filePath) {
+    // the build transcodes wav sources, prefer what it made
+    std::filesystem::path path = "assets/" + filePath;
+    for (const char* extension : { ".ogg", ".flac" }) {
+        std::filesystem::path compressed = path;
+        compressed.replace_extension(extension);
+        if (AssetArchive::Exists(compressed.generic_string())) {
+            return compressed.generic_string();
+        }
+    }
+
+    return path.generic_string();
+}
+
+FMOD_RESULT AudioManager::create(const std::string& filePath, FMOD_MODE mode, FMOD::Sound** sound) {
+    std::string path = resolve(filePath);
+
+    // packed files are read straight from the mapped archive, streams point
+    // into it, samples are decoded from it once
+    if (auto bytes = AssetArchive::Find(path)) {
+        FMOD_CREATESOUNDEXINFO info = {};
+        info.cbsize = sizeof(info);
+        info.length = bytes->size();
+        mode |= (mode & FMOD_CREATESTREAM) ? FMOD_OPENMEMORY_POINT : FMOD_OPENMEMORY;
+        return system->createSound(bytes->data(), mode, &info, sound);
+    }
+
+    return system->createSound(path.c_str(), mode, 0, sound);
+}
+
+FMOD::Sound* AudioManager::open(const std::string& filePath) {
+    auto it = streams.find(filePath);
+    if (it != streams.end()) {
+        return it->second;
+    }
+
+    // decoded a few buffers at a time on fmod's stream thread, the file is
+    // opened on its async thread
+    FMOD::Sound* sound = nullptr;
+    result = create(filePath, FMOD_CREATESTREAM | FMOD_NONBLOCKING | FMOD_LOOP_NORMAL | FMOD_2D, &sound);
+
+    if (result != FMOD_OK) {
+        print("failed to open sound", filePath);
+        return nullptr;
+    }
+
+    streams[filePath] = sound;
+    return sound;
+}
+
+bool AudioManager::isReady(FMOD::Sound* sound) {
+    FMOD_OPENSTATE state;
+    sound->getOpenState(&state, 0, 0, 0);
+    return state == FMOD_OPENSTATE_READY;
+}
+
+void AudioManager::release(const std::string& filePath) {
+    auto it = streams.find(filePath);
+    if (it != streams.end()) {
+        it->second->release();
+        streams.erase(it);
+    }
+}
+
+void AudioManager::PreloadSong(const std::string& filePath) {
+    Init();
+    open(filePath);
+}
+
+void AudioManager::PlaySong(const std::string& filePath, float fadeSeconds) {
+    Init();
+
+    if (filePath == current || filePath == pending) {
+        return;
     }
 
     print("playing sound", filePath);
 
-    result = system->createSound(("assets/" + filePath).c_str(), FMOD_DEFAULT, 0, &sound);  // Replace with your own audio file
-    result = sound->setMode(FMOD_LOOP_NORMAL);
-    result = system->playSound(sound, 0, false, &channel);
+    FMOD::Sound* sound = open(filePath);
+    if (sound == nullptr) {
+        return;
+    }
+
+    if (!pending.empty()) {
+        release(pending);
+        pending.clear();
+    }
+
+    if (isReady(sound)) {
+        start(filePath, fadeSeconds);
+    } else {
+        pending = filePath;
+        pendingFade = fadeSeconds;
+    }
+}
+
+void AudioManager::start(const std::string& filePath, float fadeSeconds) {
+    int rate = 0;
+    system->getSoftwareFormat(&rate, 0, 0);
+    unsigned long long length = fadeSeconds * rate;
+    unsigned long long clock = 0;
+
+    // a song that is still fading out is cut short
+    if (fadingChannel != nullptr) {
+        fadingChannel->stop();
+        fadingChannel = nullptr;
+        if (fading != filePath) {
+            release(fading);
+        }
+        fading.clear();
+    }
+
+    // fade points are on the mixer clock, so the fade runs without us
+    if (channel != nullptr) {
+        channel->getDSPClock(0, &clock);
+        channel->addFadePoint(clock, 1.0f);
+        channel->addFadePoint(clock + length, 0.0f);
+        channel->setDelay(0, clock + length, true);
+
+        fading = current;
+        fadingChannel = channel;
+        channel = nullptr;
+        current.clear();
+    }
+
+    result = system->playSound(streams[filePath], 0, true, &channel);
+    if (result != FMOD_OK) {
+        print("failed to play sound", filePath);
+        channel = nullptr;
+        return;
+    }
+
+    if (length > 0) {
+        channel->getDSPClock(0, &clock);
+        channel->addFadePoint(clock, 0.0f);
+        channel->addFadePoint(clock + length, 1.0f);
+    }
+    channel->setPaused(false);
+    current = filePath;
+}
+
+void AudioManager::Update() {
+    if (system == nullptr) {
+        return;
+    }
+
+    if (!pending.empty()) {
+        FMOD_OPENSTATE state;
+        streams[pending]->getOpenState(&state, 0, 0, 0);
+
+        if (state == FMOD_OPENSTATE_READY) {
+            start(pending, pendingFade);
+            pending.clear();
+        } else if (state == FMOD_OPENSTATE_ERROR) {
+            print("failed to open sound", pending);
+            release(pending);
+            pending.clear();
+        }
+    }
+
+    if (fadingChannel != nullptr) {
+        // a channel that stopped is no longer a valid handle
+        bool playing = false;
+        if (fadingChannel->isPlaying(&playing) != FMOD_OK || !playing) {
+            fadingChannel = nullptr;
+            release(fading);
+            fading.clear();
+        }
+    }
+
+    system->update();
+}
+
+void AudioManager::LoadSample(SampleId id, const std::string& filePath) {
+    Init();
+    std::lock_guard<std::mutex> lock(samplesMutex);
+
+    if (samples.contains(id)) {
+        return;
+    }
+
+    FMOD::Sound* sound = nullptr;
+    result = create(filePath, FMOD_CREATESAMPLE | FMOD_NONBLOCKING | FMOD_LOOP_OFF | FMOD_2D, &sound);
+
+    if (result != FMOD_OK) {
+        print("failed to load sample", filePath);
+        return;
+    }
+
+    samples[id] = sound;
+}
+
+void AudioManager::PlaySample(SampleId id, int priority, float volume, float pitch) {
+    std::lock_guard<std::mutex> lock(samplesMutex);
+
+    auto it = samples.find(id);
+    if (system == nullptr || it == samples.end() || !isReady(it->second)) {
+        return;
+    }
+
+    Voice* voice = nullptr;
+    for (Voice& v : voices) {
+        bool playing = false;
+        if (v.channel == nullptr || v.channel->isPlaying(&playing) != FMOD_OK || !playing) {
+            voice = &v;
+            break;
+        }
+
+        if (v.priority <= priority
+            && (voice == nullptr
+              || v.priority < voice->priority
+              || (v.priority == voice->priority && v.started < voice->started))) {
+            voice = &v;
+        }
+    }
+
+    if (voice == nullptr) {
+        return;
+    }
+
+    if (voice->channel != nullptr) {
+        voice->channel->stop();
+    }
+
+    FMOD::Channel* channel = nullptr;
+    if (system->playSound(it->second, 0, true, &channel) != FMOD_OK) {
+        voice->channel = nullptr;
+        return;
+    }
+
+    channel->setVolume(volume);
+    channel->setPitch(pitch);
+    channel->setPaused(false);
+
+    voice->channel = channel;
+    voice->priority = priority;
+    voice->started = voiceCount++;
 }
 
 void AudioManager::Cleanup() {
-    if (sound != nullptr) {
+    if (system == nullptr) {
+        return;
+    }
+
+    for (auto& [filePath, sound] : streams) {
+        sound->release();
+    }
+    streams.clear();
+
+    for (auto& [id, sound] : samples) {
         sound->release();
-        sound = nullptr;
     }
+    samples.clear();
+    voices = {};
+    channel = nullptr;
+    fadingChannel = nullptr;
 
     system->close();
     system->release();
+    system = nullptr;
 }
@@ -1,15 +1,68 @@
+#pragma once
+
 #include <fmod.hpp>
+#include <array>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+
+// interned sample names, "blip"_hs with entt's literals
+using SampleId = std::uint32_t;
 
+// Songs are streamed from disk instead of being decoded into memory, and are
+// opened in the background so nothing blocks the main thread. Changing songs
+// crossfades the old one into the new one. Paths name the wav source, an ogg
+// or flac of the same name is played instead when there is one, the build
+// packs its transcodes into the archive. Sounds come from the asset archive
+// when it has them.
+//
+// Sound effects are samples decoded into memory once and played on a fixed
+// pool of voices. When every voice is busy the quietest priority that is not
+// above the new sound's is stopped for it, otherwise the new sound is dropped.
 class AudioManager {
 private:
+    struct Voice {
+        FMOD::Channel* channel = nullptr;
+        int priority = 0;
+        unsigned int started = 0;  // to steal the oldest among equals
+    };
+
+    static std::unordered_map<SampleId, FMOD::Sound*> samples;
+    static std::array<Voice, 8> voices;
+    static unsigned int voiceCount;  // sounds started so far
+    static std::mutex samplesMutex;  // samples can be played from update systems
+
     static FMOD::System* system;
-    static FMOD::Sound* sound;
+    static std::unordered_map<std::string, FMOD::Sound*> streams;  // opened or opening, by path
+    static std::string current;
     static FMOD::Channel* channel;
+    static std::string fading;  // the previous song while it fades out
+    static FMOD::Channel* fadingChannel;
+    static std::string pending;  // asked to play before its stream was open
+    static float pendingFade;
     static FMOD_RESULT result;
+    static std::mutex initMutex;
+
+    static std::string resolve(const std::string& filePath);
+    static FMOD_RESULT create(const std::string& filePath, FMOD_MODE mode, FMOD::Sound** sound);
+    static FMOD::Sound* open(const std::string& filePath);
+    static bool isReady(FMOD::Sound* sound);
+    static void start(const std::string& filePath, float fadeSeconds);
+    static void release(const std::string& filePath);
 
 public:
     static void Init();
-    static void PlaySong(const std::string& filePath);
+    // starts opening the stream, call it while a scene is being prepared so
+    // PlaySong finds it ready
+    static void PreloadSong(const std::string& filePath);
+    static void PlaySong(const std::string& filePath, float fadeSeconds = 1.0f);
+    // once per frame, finishes fades and starts songs whose stream just opened
+    static void Update();
     static void Cleanup();
+
+    // decoded into memory on fmod's async thread, loading an id twice is a no-op
+    static void LoadSample(SampleId id, const std::string& filePath);
+    // does nothing while the sample is still loading, priority is higher wins
+    static void PlaySample(SampleId id, int priority = 0, float volume = 1.0f, float pitch = 1.0f);
 };
@@ -7,11 +7,13 @@
 #include "ECS/Components.h"
 #include "Game/Graphics/Texture.h"
 #include "Game/Graphics/PixelShader.h"
+#include "Game/Graphics/TextureManager.h"
+#include "PocketAi/Palettes.h"
 
 struct PlayerTextComponent {
   int x = 0;
   int y = 0;
-  SDL_Color color{226, 246, 228};
+  SDL_Color color = ClassicPalette[3];
   int maxLineLength = 28;
   int maxLines = 7;
   TTF_Font* font = nullptr;
@@ -50,6 +52,10 @@ struct AffectionComponent {
   int affection = 60;
 };
 
+struct BlushComponent {
+  TextureHandle texture;
+};
+
 
 
 /*
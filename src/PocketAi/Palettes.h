@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "Game/Graphics/Palette.h"
+
+// the shades every asset is drawn with
+inline constexpr Palette ClassicPalette = {{{
+  {  51,  44,  80, 255 },
+  {  70, 135, 143, 255 },
+  { 148, 227,  68, 255 },
+  { 226, 243, 228, 255 },
+}}};
+
+// one per day. every day keeps the classic shades until the art has its own
+// palettes, a day set to another palette gets its sprites remapped to it.
+// text and the cursor are drawn in ClassicPalette[3], a palette that moves
+// that shade has to be passed to them too
+inline constexpr std::array<Palette, 4> DayPalettes = {
+  ClassicPalette,
+  ClassicPalette,
+  ClassicPalette,
+  ClassicPalette,
+};
+
+// the remap tables, built at compile time
+inline constexpr std::array<PaletteMap, 4> DayPaletteMaps = {
+  mapPalette(ClassicPalette, DayPalettes[0]),
+  mapPalette(ClassicPalette, DayPalettes[1]),
+  mapPalette(ClassicPalette, DayPalettes[2]),
+  mapPalette(ClassicPalette, DayPalettes[3]),
+};
+
+// no shader while the day's palette is the classic one
+inline PixelShader dayPalette(int day) {
+  return paletteShader(DayPaletteMaps[day - 1], "day" + std::to_string(day));
+}
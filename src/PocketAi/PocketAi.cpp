@@ -6,71 +6,115 @@
 
 #include "ECS/Components.h"
 #include "ECS/Entity.h"
+#include "Game/Startup.h"
 
 #include "PocketAi/Ai/AiManager.h"
+#include "PocketAi/Audio/AudioManager.h"
 #include "PocketAi/Systems/AiSystems.h"
 #include "PocketAi/Systems/GeneralSystems.h"
 #include "PocketAi/Systems/SpriteSystems.h"
 #include "PocketAi/Systems/TextSystems.h"
 #include "Systems/Systems.h"
 #include "Components.h"
+#include "Palettes.h"
+
+using namespace entt::literals;
 
 
 PocketAi::PocketAi()
-  : Game("Ai", SCREEN_WIDTH * SCALE, SCREEN_HEIGHT * SCALE) { }
+  : Game("Ai", SCREEN_WIDTH * SCALE, SCREEN_HEIGHT * SCALE, TARGET_FPS, VSYNC) {
+  upcoming = nullptr;
+  prepareAhead = true;
+  transitionRequested = false;
+}
 
 PocketAi::~PocketAi() {
     // destructor implementation
   // temporarily clean the ai manager here
   AiManager::tearDown();
+  AudioManager::Cleanup();
+}
+
+void PocketAi::update() {
+  Game::update();
+
+  // the scene is done with its frame, it's safe to throw it away now
+  if (transitionRequested.exchange(false)) {
+    nextScene();
+  }
+
+  AudioManager::Update();
 }
 
 void PocketAi::sceneTransition() {
+  // called by the current scene's own systems, some of them on a worker
+  // thread, so the switch waits until the update is over. asking more than
+  // once in a frame still moves a single scene ahead
+  transitionRequested = true;
+}
+
+Scene* PocketAi::buildScene() {
+  if (sceneFactories.empty()) {
+    return nullptr;
+  }
+
+  Scene* scene = sceneFactories.front()();
+  sceneFactories.pop_front();
+  return scene;
+}
+
+void PocketAi::nextScene() {
+  // its systems and entities go with it
   delete this->getCurrentScene();
   this->setScene(nullptr);
 
-  if (!this->scenes.empty()) {
-    Scene* newScene = this->scenes.front();
-    this->setScene(newScene);
-    this->scenes.pop();
+  Scene* scene = upcoming != nullptr ? upcoming : buildScene();
+  upcoming = nullptr;
+  this->setScene(scene);
+
+  // the next scene loads its assets while this one plays
+  if (prepareAhead) {
+    upcoming = buildScene();
+    if (upcoming != nullptr) {
+      upcoming->prepare();
+    }
   }
 }
 
 void PocketAi::setup() {
-  Scene* logoScene = createLogoScene();
-  Scene* creditsScene = createCreditsScene();
-  Scene* jamScene = createJamScene();
-  Scene* titleScene = createTitleScene();
-  Scene* contextScene1 = createContextScene(1);
-  Scene* gameplayScene1 = createGameplayScene(1);
-  Scene* contextScene2 = createContextScene(2);
-  Scene* gameplayScene2 = createGameplayScene(2);
-  Scene* contextScene3 = createContextScene(3);
-  Scene* gameplayScene3 = createGameplayScene(3);
-  Scene* contextScene4 = createContextScene(4);
-  Scene* gameplayScene4 = createGameplayScene(4);
-  Scene* conclusionRequestScene = createConclusionScene(false);
-  Scene* conclusionResponseScene = createConclusionScene(true);
-  Scene* endingScene = createEndingScene();
-
-
-  // this is the scene queue, we push the scenes in order
-  setScene(logoScene);
-  scenes.push(creditsScene); 
-  scenes.push(jamScene); 
-  scenes.push(titleScene); 
-  scenes.push(contextScene1);
-  scenes.push(gameplayScene1);
-  scenes.push(contextScene2);
-  scenes.push(gameplayScene2);
-  scenes.push(contextScene3);
-  scenes.push(gameplayScene3);
-  scenes.push(contextScene4);
-  scenes.push(gameplayScene4);
-  scenes.push(conclusionRequestScene);
-  scenes.push(conclusionResponseScene);
-  scenes.push(endingScene);
-
+  StartupGraph startup;
+
+  // fmod opens the audio device and starts its mixer thread, the logo scene
+  // plays no sound so it doesn't wait for it
+  startup.add("audio", {}, [] {
+    AudioManager::Init();
+  });
+
+  // scenes are only built when they're about to play, one ahead at most
+  startup.add("scenes", {}, [&] {
+    sceneFactories = {
+      [this] { return createLogoScene(); },
+      [this] { return createCreditsScene(); },
+      [this] { return createJamScene(); },
+      [this] { return createTitleScene(); },
+    };
+
+    for (int day = 1; day <= 4; day++) {
+      sceneFactories.push_back([this, day] { return createContextScene(day); });
+      sceneFactories.push_back([this, day] { return createGameplayScene(day); });
+    }
+
+    sceneFactories.push_back([this] { return createConclusionScene(false); });
+    sceneFactories.push_back([this] { return createConclusionScene(true); });
+    sceneFactories.push_back([this] { return createEndingScene(); });
+  }, true);
+
+  // starts the model loading in the background and the logo decoding
+  startup.add("logo", { "scenes" }, [&] {
+    nextScene();
+  }, true);
+
+  startup.run();
 }
 
 Scene* PocketAi::createCreditsScene() {
@@ -86,7 +130,7 @@ Scene* PocketAi::createCreditsScene() {
 
   addUpdateSystem<SceneTransitionOnSlideUpdateSystem>(
     scene,
-    std::bind(&PocketAi::sceneTransition, this)
+    [this] { sceneTransition(); }
   );
 
   return scene;
@@ -98,7 +142,6 @@ Scene* PocketAi::createLogoScene() {
   // we must add the ai setup system from the start since it takes so long
   addSetupSystem<AiSetupSystem>(scene);
   addSetupSystem<AffectionSetupSystem>(scene);
-  addSetupSystem<MusicSetupSystem>(scene);
   
   SpriteComponent sprite = {
         "Backgrounds/gamedev.png",
@@ -106,7 +149,6 @@ Scene* PocketAi::createLogoScene() {
         0, 0,
         50, 2500,
         PixelShader{ nullptr, "" },
-        0,
         true,
         5000
   };
@@ -118,7 +160,7 @@ Scene* PocketAi::createLogoScene() {
 
   addUpdateSystem<SceneTransitionOnSlideUpdateSystem>(
     scene,
-    std::bind(&PocketAi::sceneTransition, this)
+    [this] { sceneTransition(); }
   );
 
   return scene;
@@ -132,7 +174,6 @@ Scene* PocketAi::createJamScene() {
         0, 0,
         30, 1000,
         PixelShader{ nullptr, "" },
-        0,
         true,
         1000
   };
@@ -144,7 +185,7 @@ Scene* PocketAi::createJamScene() {
 
   addUpdateSystem<SceneTransitionOnSlideUpdateSystem>(
     scene,
-    std::bind(&PocketAi::sceneTransition, this)
+    [this] { sceneTransition(); }
   );
 
   return scene;
@@ -158,11 +199,11 @@ Scene* PocketAi::createTitleScene() {
         0, 0,
         2, 1000,
         PixelShader{ nullptr, "" },
-        0,
         false,
         3000
   };
   addSetupSystem<MusicPlaySystem>(scene, "Music/daydreamers_intro.wav");
+  addSetupSystem<SampleSetupSystem>(scene, "blip"_hs, "Sounds/blip.wav");
   addSetupSystem<SlideShowSetupSystem>(scene, sprite);
   addSetupSystem<SpriteSetupSystem>(scene, renderer);
   addUpdateSystem<SpriteUpdateSystem>(scene);
@@ -171,7 +212,7 @@ Scene* PocketAi::createTitleScene() {
 
   addEventSystem<PressStartEventSystem>(
     scene,
-    std::bind(&PocketAi::sceneTransition, this)
+    [this] { sceneTransition(); }
   );
 
   return scene;
@@ -190,14 +231,18 @@ Scene* PocketAi::createContextScene(int day) {
   /* } */
 
   // sprite / ui systems
-  addSetupSystem<UiSetupSystem>(scene, renderer, "UI/simple.png", day);
-  addRenderSystem<SpriteRenderSystem>(scene);
+  addSetupSystem<UiSetupSystem>(scene, renderer, "UI/simple.png", day, dayPalette(day));
   addSetupSystem<SpriteSetupSystem>(scene, renderer);
 
   // text systems
-  addRenderSystem<PlayerCursorRenderSystem>(scene);
   addSetupSystem<PlayerTextSetupSystem>(scene);
-  addRenderSystem<PlayerTextRenderSystem>(scene);
+
+  addRenderPipeline(
+    scene,
+    SpriteRenderSystem(),
+    PlayerCursorRenderSystem(),
+    PlayerTextRenderSystem()
+  );
 
   std::string context;
   switch (day) {
@@ -222,7 +267,7 @@ Scene* PocketAi::createContextScene(int day) {
   addEventSystem<TextCrawlEventSystem>(
     scene,
     context,
-    std::bind(&PocketAi::sceneTransition, this)
+    [this] { sceneTransition(); }
   );
 
   return scene;
@@ -230,16 +275,14 @@ Scene* PocketAi::createContextScene(int day) {
 
 Scene* PocketAi::createGameplayScene(int day) {
   Scene* scene = new Scene("GAMEPLAY SCENE " + std::to_string(day), r);
-  addSetupSystem<CharacterSetupSystem>(scene);
+  addSetupSystem<CharacterSetupSystem>(scene, dayPalette(day));
   
   // sprite / ui systems
-  addSetupSystem<UiSetupSystem>(scene, renderer, "UI/main.png");
-  addSetupSystem<BackgroundSetupSystem>(scene, day - 1);
+  addSetupSystem<UiSetupSystem>(scene, renderer, "UI/main.png", 0, dayPalette(day));
+  addSetupSystem<BackgroundSetupSystem>(scene, day - 1, dayPalette(day));
   addSetupSystem<SpriteSetupSystem>(scene, renderer);
   addUpdateSystem<SpriteUpdateSystem>(scene);
-  addRenderSystem<SpriteRenderSystem>(scene);
-  addSetupSystem<BlushSetupSystem>(scene, renderer);
-  addRenderSystem<BlushRenderSystem>(scene);
+  addSetupSystem<BlushSetupSystem>(scene, renderer, dayPalette(day));
 
   // ai systems
   /* addSetupSystem<AiSetupSystem>(scene); */
@@ -251,13 +294,19 @@ Scene* PocketAi::createGameplayScene(int day) {
   // text systems
   addEventSystem<PlayerTextInputSystem>(scene);
   addSetupSystem<PlayerTextSetupSystem>(scene);
-  addRenderSystem<PlayerTextRenderSystem>(scene);
-  addRenderSystem<PlayerCursorRenderSystem>(scene);
   addSetupSystem<ConversationSetupSystem>(scene, 3); // TODO: move to lua
 
+  addRenderPipeline(
+    scene,
+    SpriteRenderSystem(),
+    BlushRenderSystem(),
+    PlayerTextRenderSystem(),
+    PlayerCursorRenderSystem()
+  );
+
   addUpdateSystem<AiConversationProgressSystem>(
     scene,
-    std::bind(&PocketAi::sceneTransition, this),
+    [this] { sceneTransition(); },
     day
   );
  
@@ -270,17 +319,21 @@ Scene* PocketAi::createConclusionScene(bool isResponse) {
   addSetupSystem<CharacterSetupSystem>(scene);
   addSetupSystem<UiSetupSystem>(scene, renderer, "UI/conclusion.png");
   addSetupSystem<SpriteSetupSystem>(scene, renderer);
-  addRenderSystem<SpriteRenderSystem>(scene);
   addUpdateSystem<SlideShowUpdateSystem>(scene);
 
-  addRenderSystem<PlayerCursorRenderSystem>(scene);
   addSetupSystem<PlayerTextSetupSystem>(
     scene,
     25, 94,
     22, 6, 
-    SDL_Color{ 51, 44, 80 }
+    ClassicPalette[0]
+  );
+
+  addRenderPipeline(
+    scene,
+    SpriteRenderSystem(),
+    PlayerCursorRenderSystem(),
+    PlayerTextRenderSystem()
   );
-  addRenderSystem<PlayerTextRenderSystem>(scene);
 
   if (!isResponse) {  // this is the first conclusion slide
     std::string context = "After spending time with her the last few days, you finally decide to ask her how she feels about you...";
@@ -290,7 +343,7 @@ Scene* PocketAi::createConclusionScene(bool isResponse) {
     addEventSystem<TextCrawlEventSystem>(
       scene,
       context,
-      std::bind(&PocketAi::sceneTransition, this)
+      [this] { sceneTransition(); }
     );
   } else {
     addSetupSystem<ConversationSetupSystem>(scene, 1);
@@ -299,7 +352,7 @@ Scene* PocketAi::createConclusionScene(bool isResponse) {
     addUpdateSystem<AiEmotionProcessingSystem>(scene);
     addUpdateSystem<AiConversationProgressSystem>(
       scene,
-      std::bind(&PocketAi::sceneTransition, this),
+      [this] { sceneTransition(); },
       0
     );
    }
@@ -316,7 +369,6 @@ Scene* PocketAi::createEndingScene() {
         0, 0,
         30, 1000,
         PixelShader{ nullptr, "" },
-        0,
         true,
         1000
   };
@@ -329,7 +381,7 @@ Scene* PocketAi::createEndingScene() {
 
   addUpdateSystem<SceneTransitionOnSlideUpdateSystem>(
     scene,
-    std::bind(&PocketAi::sceneTransition, this)
+    [this] { sceneTransition(); }
   );
 
   return scene;
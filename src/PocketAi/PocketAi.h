@@ -2,7 +2,9 @@
 
 #include "Game/Game.h"
 
-#include <queue>
+#include <atomic>
+#include <deque>
+#include <functional>
 
 class PocketAi : public Game {
   public:
@@ -10,10 +12,19 @@ class PocketAi : public Game {
     ~PocketAi();
 
     void setup() override;
+    void update() override;
     void sceneTransition();
 
   private:
-    std::queue<Scene*> scenes;
+    // the scenes still to come, in order, each one is built when it's needed
+    std::deque<std::function<Scene*()>> sceneFactories;
+    Scene* upcoming;  // built and preparing while the current one plays
+    bool prepareAhead;
+    std::atomic<bool> transitionRequested;
+
+    Scene* buildScene();
+    void nextScene();
+
     Scene* createLogoScene();
     Scene* createCreditsScene();
     Scene* createJamScene();
@@ -9,6 +9,9 @@
 #include "ECS/Components.h"
 #include "PocketAi/Components.h"
 #include "PocketAi/Ai/AiManager.h"
+#include "PocketAi/Audio/AudioManager.h"
+
+using namespace entt::literals;
 
 AiSetupSystem::~AiSetupSystem() {
   /* AiManager::tearDown(); */
@@ -19,13 +22,27 @@ void AiSetupSystem::run() {
   /* AiManager::setUp( "Rob:", "Pocket:", "baka-high.txt"); */
 }
 
+AiPromptProcessingSystem::AiPromptProcessingSystem() {
+  // only talks to the ai manager queues, model work runs in its own arena
+  independent();
+}
+
 void AiPromptProcessingSystem::run(double dT) {
   AiManager::run();
 }
 
+AiPromptPostProcessingSystem::AiPromptPostProcessingSystem() {
+  writes<
+    ConversationComponent,
+    PlayerTextComponent,
+    PlayerPromptComponent,
+    PlayerEmotionComponent
+  >();
+}
+
 void AiPromptPostProcessingSystem::run(double dT) {
   Uint32 now = SDL_GetTicks();  
-  auto& conversationComponent = scene->player->get<ConversationComponent>();
+  auto& conversationComponent = scene->player.get<ConversationComponent>();
 
   if (conversationComponent.lastLetterTime == 0) {
     conversationComponent.lastLetterTime = now;
@@ -38,9 +55,9 @@ void AiPromptPostProcessingSystem::run(double dT) {
 
   std::string output;
   if (AiManager::responseQueue.try_pop(output)) {
-    auto& textComponent = scene->player->get<PlayerTextComponent>();
-    auto& promptComponent = scene->player->get<PlayerPromptComponent>();
-    auto& emotionComponent = scene->player->get<PlayerEmotionComponent>();
+    auto& textComponent = scene->player.get<PlayerTextComponent>();
+    auto& promptComponent = scene->player.get<PlayerPromptComponent>();
+    auto& emotionComponent = scene->player.get<PlayerEmotionComponent>();
 
     if (emotionComponent.isProcessingEmotion) {
       if (output == " ") {  // we are at the end of an emotion
@@ -53,6 +70,11 @@ void AiPromptPostProcessingSystem::run(double dT) {
         emotionComponent.isProcessingEmotion = true;
       } else {
         textComponent.text += output;
+        scene->markDirty();
+
+        if (output.find_first_not_of(" \n") != std::string::npos) {
+          AudioManager::PlaySample("blip"_hs);
+        }
 
         // we check if there is an antiprompt at the end of the prompt.
         if (AiManager::endsWithAntiPrompt(textComponent.text)) {
@@ -74,9 +96,13 @@ std::unordered_map<std::string, int> emotionMap {
   {"angry", 5}
 };
 
+AiEmotionProcessingSystem::AiEmotionProcessingSystem() {
+  writes<PlayerEmotionComponent, SpriteRenderComponent, AffectionComponent>();
+}
+
 void AiEmotionProcessingSystem::run(double dT) {
-  auto& emotionComponent = scene->player->get<PlayerEmotionComponent>();
-  auto& playerSpriteComponent = scene->player->get<SpriteComponent>();
+  auto& emotionComponent = scene->player.get<PlayerEmotionComponent>();
+  auto& playerSpriteComponent = scene->player.get<SpriteRenderComponent>();
   auto& affection = scene->r.ctx().get<AffectionComponent>().affection;
 
   int value = (emotionMap.find(emotionComponent.emotion) != emotionMap.end()) ? emotionMap[emotionComponent.emotion] : -1;
@@ -88,6 +114,7 @@ void AiEmotionProcessingSystem::run(double dT) {
     std::uniform_int_distribution<int> dist(0, 4);
     int random_number = dist(mt);
     playerSpriteComponent.yIndex = std::clamp(random_number, 1, 3) - 1;
+    scene->markDirty();  // new expression, and the blush may toggle
     
     vprint(emotionComponent.emotion);
     emotionComponent.emotion = "";
@@ -116,8 +143,8 @@ AiConversationProgressSystem::AiConversationProgressSystem(std::function<void()>
   : changeScene(changeScene), day(day) { }
 
 void AiConversationProgressSystem::run(double dT) {
-  auto& conversationComponent = scene->player->get<ConversationComponent>();
-  auto& playerPromptComponent = scene->player->get<PlayerPromptComponent>();
+  auto& conversationComponent = scene->player.get<ConversationComponent>();
+  auto& playerPromptComponent = scene->player.get<PlayerPromptComponent>();
   const auto affection = scene->r.ctx().get<AffectionComponent>().affection;
 
   if (playerPromptComponent.isInteracting && conversationComponent.countConversations > conversationComponent.maxConversations) {
@@ -146,7 +173,7 @@ void AiConfessionRequestSetupSystem::run() {
 }
 
 void AiEndingSetupSystem::run() {
-  auto view = scene->r.view<SpriteComponent>();
+  auto view = scene->r.view<SpriteRenderComponent>();
   const auto affection = scene->r.ctx().get<AffectionComponent>().affection;
 
   print("affection at ending is", affection);
@@ -159,8 +186,7 @@ void AiEndingSetupSystem::run() {
     ending = 0;
   }
 
-  for(auto entity : view) {
-    auto& spriteComponent = scene->r.get<SpriteComponent>(entity);
+  for(auto [entity, spriteComponent] : view.each()) {
     spriteComponent.xIndex = ending;
   }
 }
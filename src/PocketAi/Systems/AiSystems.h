@@ -12,16 +12,19 @@ public:
 
 class AiPromptProcessingSystem : public UpdateSystem {
 public:
+  AiPromptProcessingSystem();
   void run(double dT);
 };
 
 class AiPromptPostProcessingSystem : public UpdateSystem {
 public:
+  AiPromptPostProcessingSystem();
   void run(double dT);
 };
 
 class AiEmotionProcessingSystem : public UpdateSystem {
 public:
+  AiEmotionProcessingSystem();
   void run(double dT);
 };
 
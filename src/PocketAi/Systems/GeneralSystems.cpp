@@ -9,18 +9,20 @@
 
 #include "PocketAi/Audio/AudioManager.h"
 
-CharacterSetupSystem::~CharacterSetupSystem() {
-    delete scene->player;
-    scene->player = nullptr;
+CharacterSetupSystem::CharacterSetupSystem(PixelShader palette)
+    : palette(palette) { }
+
+void CharacterSetupSystem::prepare() {
+    TextureLoader::Prefetch("assets/Characters/main.png", palette);
 }
 
 void CharacterSetupSystem::run() {
-    if (scene->player == nullptr) {
-        scene->player = new Entity(scene->r.create(), scene);
-        scene->player->addComponent<TransformComponent>(0, 24 * SCALE);  // ui offset
-        scene->player->addComponent<SpriteComponent>("Characters/main.png", 160, 65, 0, 0);
-        scene->player->addComponent<PlayerEmotionComponent>();
-        scene->player->addComponent<PlayerPromptComponent>("Pocket: ", "Rob: ");
+    if (!scene->player) {
+        scene->player = scene->create();
+        scene->player.addComponent<TransformComponent>(0, 24 * SCALE);  // ui offset
+        scene->player.addComponent<SpriteComponent>("Characters/main.png", 160, 65, 0, 0, 0, 0, palette);
+        scene->player.addComponent<PlayerEmotionComponent>();
+        scene->player.addComponent<PlayerPromptComponent>("Pocket: ", "Rob: ");
     }
 }
 
@@ -30,9 +32,7 @@ SceneTransitionOnSlideUpdateSystem::SceneTransitionOnSlideUpdateSystem(std::func
 void SceneTransitionOnSlideUpdateSystem::run(double dT) {
     auto view = scene->r.view<SlideShowComponent>();
 
-    for (auto entity : view) {
-        auto& slideComponent = scene->r.get<SlideShowComponent>(entity);
-   
+    for (auto [entity, slideComponent] : view.each()) {
         if (slideComponent.currentSlide >= slideComponent.slideCount) {
           changeScene();
         }
@@ -40,12 +40,13 @@ void SceneTransitionOnSlideUpdateSystem::run(double dT) {
 }
 
 PressStartEventSystem::PressStartEventSystem(std::function<void()> changeScene)
-: changeScene(changeScene) { }
+: changeScene(changeScene) {
+    listensToKeys(SDLK_RETURN);
+}
 
 void PressStartEventSystem::run(SDL_Event event) {
-    if (event.key.keysym.sym == SDLK_RETURN) {
-        changeScene();
-    }
+    // only return presses are routed here
+    changeScene();
 }
 
 void AffectionSetupSystem::run() {
@@ -57,16 +58,29 @@ ConversationSetupSystem::ConversationSetupSystem(int maxLines)
     : maxLines(maxLines) { }
 
 void ConversationSetupSystem::run() {
-    scene->player->addComponent<ConversationComponent>(maxLines, 0, 50);
+    scene->player.addComponent<ConversationComponent>(maxLines, 0, 50);
 }
 
 void MusicSetupSystem::run() {
     AudioManager::Init();
 };
 
+SampleSetupSystem::SampleSetupSystem(SampleId id, const std::string& sample)
+    : id(id), sample(sample) { }
+
+void SampleSetupSystem::prepare() {
+    AudioManager::LoadSample(id, sample);
+}
+
+void SampleSetupSystem::run() { }
+
 MusicPlaySystem::MusicPlaySystem(const std::string& song)
     : song(song) { }
 
+void MusicPlaySystem::prepare() {
+    AudioManager::PreloadSong(song);
+}
+
 void MusicPlaySystem::run() {
     AudioManager::PlaySong(song);
 }
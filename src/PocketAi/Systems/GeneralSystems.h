@@ -4,14 +4,19 @@
 #include <SDL_pixels.h>
 #include <SDL_render.h>
 #include <functional>
+#include <memory>
 
 #include "ECS/System.h"
+#include "Game/Graphics/TextureLoader.h"
+#include "PocketAi/Audio/AudioManager.h"
 
 class CharacterSetupSystem : public SetupSystem {
 public:
-  /* CharacterSetupSystem(); */
-  ~CharacterSetupSystem();
+  CharacterSetupSystem(PixelShader palette = {nullptr, ""});
+  void prepare() override;
   void run() override;
+private:
+  PixelShader palette;
 };
 
 class SceneTransitionOnSlideUpdateSystem : public UpdateSystem {
@@ -48,9 +53,22 @@ public:
   void run() override;
 };
 
+// loads a sound effect into the bank while the scene is prepared, it stays
+// loaded for the rest of the game
+class SampleSetupSystem : public SetupSystem {
+public:
+  SampleSetupSystem(SampleId id, const std::string& sample);
+  void prepare() override;
+  void run() override;
+private:
+  SampleId id;
+  std::string sample;
+};
+
 class MusicPlaySystem : public SetupSystem {
 public:
   MusicPlaySystem(const std::string& song);
+  void prepare() override;
   void run() override;
 private:
   std::string song;
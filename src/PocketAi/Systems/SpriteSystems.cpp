@@ -9,78 +9,90 @@
 
 #include "ECS/Entity.h"
 #include "ECS/Components.h"
+#include "Game/Graphics/TextureLoader.h"
 #include "Game/Graphics/TextureManager.h"
 
 #include "PocketAi/Components.h"
 
-UiSetupSystem::UiSetupSystem(SDL_Renderer* renderer, std::string spriteFile, int day)
-    : renderer(renderer), spriteFile(spriteFile), day(day) { }
+UiSetupSystem::UiSetupSystem(SDL_Renderer* renderer, std::string spriteFile, int day, PixelShader palette)
+    : renderer(renderer), spriteFile(spriteFile), day(day), palette(palette) { }
 
-UiSetupSystem::~UiSetupSystem() {
-    scene->world->removeComponent<SpriteComponent>();
+void UiSetupSystem::prepare() {
+    TextureLoader::Prefetch("assets/" + spriteFile, palette);
 }
 
 void UiSetupSystem::run() {
     /* TextureManager::LoadTexture(spriteFile, renderer); */
-    if (scene->world == nullptr) {
-        scene->world = new Entity(scene->r.create(), scene);
+    if (!scene->world) {
+        scene->world = scene->create();
     }
-    scene->world->addComponent<TransformComponent>(0, 0);
-    scene->world->addComponent<SpriteComponent>(spriteFile, 160, 144, day, 0);
+    scene->world.addComponent<TransformComponent>(0, 0);
+    scene->world.addComponent<SpriteComponent>(spriteFile, 160, 144, day, 0, 0, 0, palette);
 }
 
 
 
+UiUpdateSystem::UiUpdateSystem() {
+    reads<AffectionComponent>();
+    writes<SpriteRenderComponent>();
+}
+
 void UiUpdateSystem::run(double dT) {
-    auto& uiSpriteComponent = scene->world->get<SpriteComponent>();
+    auto& uiSpriteComponent = scene->world.get<SpriteRenderComponent>();
     const auto& affection = scene->r.ctx().get<AffectionComponent>().affection;
 
-    uiSpriteComponent.xIndex = std::clamp(static_cast<int>(affection / 16), 0, 5);
+    int xIndex = std::clamp(static_cast<int>(affection / 16), 0, 5);
+    if (uiSpriteComponent.xIndex != xIndex) {
+        uiSpriteComponent.xIndex = xIndex;
+        scene->markDirty();
+    }
 }
 
-BackgroundSetupSystem::BackgroundSetupSystem(int day)
-    : day(day) { }
+BackgroundSetupSystem::BackgroundSetupSystem(int day, PixelShader palette)
+    : day(day), palette(palette) { }
 
-BackgroundSetupSystem::~BackgroundSetupSystem() {
-    delete bg;
+void BackgroundSetupSystem::prepare() {
+    TextureLoader::Prefetch("assets/Backgrounds/starry-sky.png", palette);
 }
 
 void BackgroundSetupSystem::run() {
-    bg = scene->createEntity("BG", 0, 24 * SCALE);
-    bg->addComponent<SpriteComponent>(
+    Entity bg = scene->createEntity("BG", 0, 24 * SCALE);
+    bg.addComponent<SpriteComponent>(
         "Backgrounds/starry-sky.png",
          160, 65,
          0,  (day + 1) % 4,
          8,
-         2000
+         2000,
+         palette
     );
 }
 
 SlideShowSetupSystem::SlideShowSetupSystem(SpriteComponent sprite, short slideCount, int slideDurationMillis)
     : sprite(sprite), slideCount(slideCount), slideDurationMillis(slideDurationMillis) {}
 
-SlideShowSetupSystem::~SlideShowSetupSystem() {
-    delete slider;
+void SlideShowSetupSystem::prepare() {
+    TextureLoader::Prefetch("assets/" + sprite.name, sprite.shader);
 }
 
 void SlideShowSetupSystem::run() {
-    slider = scene->createEntity("SLIDER", 0, 0);
-    slider->addComponent<SpriteComponent>(sprite);
-    slider->addComponent<SlideShowComponent>(
+    Entity slider = scene->createEntity("SLIDER", 0, 0);
+    slider.addComponent<SpriteComponent>(sprite);
+    slider.addComponent<SlideShowComponent>(
         slideCount,
         slideDurationMillis,
-        SDL_GetTicks()
+        scene->clock()
     );
 }
 
-void SlideShowUpdateSystem::run(double dT) {
-    Uint32 now = SDL_GetTicks();
-    auto view = scene->r.view<SlideShowComponent, SpriteComponent>();
+SlideShowUpdateSystem::SlideShowUpdateSystem() {
+    writes<SlideShowComponent, SpriteRenderComponent>();
+}
 
-    for(auto entity : view) {
-        auto& slideComponent = scene->r.get<SlideShowComponent>(entity);
-        auto& spriteComponent = scene->r.get<SpriteComponent>(entity);
+void SlideShowUpdateSystem::run(double dT) {
+    Uint32 now = scene->clock();
+    auto view = scene->r.view<SlideShowComponent, SpriteRenderComponent>();
 
+    for(auto [entity, slideComponent, spriteComponent] : view.each()) {
         if (slideComponent.slideCount > 0 && slideComponent.slideCount > slideComponent.currentSlide) {
             Uint32 timeSinceLastUpdate = now - slideComponent.lastUpdate;
 
@@ -88,45 +100,116 @@ void SlideShowUpdateSystem::run(double dT) {
                 slideComponent.lastUpdate = now; 
                 slideComponent.currentSlide++;
                 spriteComponent.xIndex = slideComponent.currentSlide;
+                scene->markDirty();
             }
         }
     }
 }
 
+SpriteRenderSystem::SpriteRenderSystem(SDL_Color tint)
+    : tint(tint) { }
+
+bool SpriteRenderSystem::StaticLayer::operator==(const StaticLayer& other) const {
+    return region == other.region && x == other.x && y == other.y;
+}
+
+bool SpriteRenderSystem::flush(SDL_Renderer* renderer, size_t runIndex) {
+    if (pending.empty()) {
+        return false;
+    }
+
+    // animated sprites queued below this run go first
+    batch.flush(renderer);
+
+    LayerRun* run = nullptr;
+    if (LayerCache::supported(renderer)) {
+        if (runs.size() <= runIndex) {
+            runs.resize(runIndex + 1);
+        }
+
+        run = &runs[runIndex];
+        if (run->cache == nullptr) {
+            run->cache = std::make_unique<LayerCache>(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+    }
+
+    // only recomposite when a layer moved or changed frame
+    bool cached = run != nullptr && run->cache->isValid() && run->layers == pending;
+    if (run != nullptr && !cached && run->cache->begin()) {
+        for (const auto& layer : pending) {
+            SDL_Rect target = { layer.x / SCALE, layer.y / SCALE, layer.region->rect.w, layer.region->rect.h };
+            batch.draw(renderer, *layer.region, target);
+        }
+        batch.flush(renderer);
+        run->cache->end();
+
+        run->layers.swap(pending);
+        cached = true;
+    }
+
+    // no render targets, or the cache texture couldn't be made
+    if (!cached) {
+        for (const auto& layer : pending) {
+            SDL_Rect target = { layer.x, layer.y, layer.region->rect.w * SCALE, layer.region->rect.h * SCALE };
+            batch.draw(renderer, *layer.region, target, tint);
+        }
+        batch.flush(renderer);
+        pending.clear();
+        return true;
+    }
+
+    run->cache->render(0, 0, SCREEN_WIDTH * SCALE, SCREEN_HEIGHT * SCALE, tint);
+    pending.clear();
+    return true;
+}
+
 void SpriteRenderSystem::run(SDL_Renderer* renderer) {
-    auto view = scene->r.view<TransformComponent, SpriteComponent>();
-    for(auto entity : view) {
-        const auto spriteComponent = view.get<SpriteComponent>(entity);
-        const auto transformComponent = view.get<TransformComponent>(entity);
-        Texture* texture = TextureManager::GetTexture(spriteComponent.name, spriteComponent.shader.name);
+    // the group owns both pools, so this walks two packed arrays in step, in
+    // the order the sprite setup system sorted them
+    auto group = scene->r.group<SpriteRenderComponent, TransformComponent>();
+    size_t runIndex = 0;
+
+    for(const auto [entity, spriteComponent, transformComponent] : group.each()) {
+        if (spriteComponent.frames == nullptr) {
+            continue;
+        }
 
-        const int width = spriteComponent.w > 0 ? spriteComponent.w : texture->width;
-        const int height = spriteComponent.h > 0 ? spriteComponent.h : texture->height;
+        const AtlasRegion* region = spriteComponent.frames->frame(spriteComponent.xIndex, spriteComponent.yIndex);
+        if (region == nullptr) {
+            continue;
+        }
 
-        SDL_Rect clip = {
-            spriteComponent.xIndex * width,
-            spriteComponent.yIndex * height,
-            width,
-            height,
-        };
-        
-        texture->render(
+        // the cache is drawn at native resolution, so only sprites sitting
+        // on the pixel grid can go in it
+        bool isStatic = !spriteComponent.animated
+            && transformComponent.x % SCALE == 0
+            && transformComponent.y % SCALE == 0;
+
+        if (isStatic) {
+            pending.push_back({ region, transformComponent.x, transformComponent.y });
+            continue;
+        }
+
+        if (flush(renderer, runIndex)) {
+            runIndex++;
+        }
+
+        SDL_Rect target = {
             transformComponent.x,
             transformComponent.y,
-            width * SCALE,
-            height * SCALE,
-            &clip
-        );
+            region->rect.w * SCALE,
+            region->rect.h * SCALE
+        };
+        batch.draw(renderer, *region, target, tint);
     }
-}
-
-SpriteSetupSystem::~SpriteSetupSystem() {
-    auto view = scene->r.view<SpriteComponent>();
 
-    for(auto entity : view) {
-        const auto spriteComponent = view.get<SpriteComponent>(entity);
-        TextureManager::UnloadTexture(spriteComponent.name, spriteComponent.shader.name);
+    if (flush(renderer, runIndex)) {
+        runIndex++;
     }
+    batch.flush(renderer);
+
+    // the scene has fewer static runs than before
+    runs.resize(runIndex);
 }
 
 SpriteSetupSystem::SpriteSetupSystem(SDL_Renderer* renderer)
@@ -134,51 +217,55 @@ SpriteSetupSystem::SpriteSetupSystem(SDL_Renderer* renderer)
 
 void SpriteSetupSystem::run() {
     auto view = scene->r.view<SpriteComponent>();
+    auto& sprites = scene->r.storage<SpriteComponent>();
+    atlas = std::make_shared<TextureAtlas>(renderer);
 
     for(auto entity : view) {
-        const auto spriteComponent = view.get<SpriteComponent>(entity);
-        TextureManager::LoadTexture(spriteComponent.name, renderer, spriteComponent.shader);
-    }
-}
-
-void SpriteUpdateSystem::run(double dT) {
-    auto view = scene->r.view<SpriteComponent>();
+        auto& spriteComponent = view.get<SpriteComponent>(entity);
+        std::string key = spriteComponent.name + spriteComponent.shader.name;
 
-    Uint32 now = SDL_GetTicks();
+        AtlasSprite* sprite = atlas->find(key);
+        if (sprite == nullptr) {
+            auto sheet = TextureLoader::Decode("assets/" + spriteComponent.name, spriteComponent.shader);
+            sprite = atlas->add(key, sheet, spriteComponent.w, spriteComponent.h);
+        }
 
-    for(auto entity : view) {
-        auto& spriteComponent = view.get<SpriteComponent>(entity);
+        scene->r.emplace_or_replace<SpriteRenderComponent>(
+            entity,
+            sprite,
+            spriteComponent.xIndex,
+            spriteComponent.yIndex,
+            spriteComponent.animationFrames > 0
+        );
 
         if (spriteComponent.animationFrames > 0) {
-            if (!spriteComponent.lastUpdate) {
-                spriteComponent.lastUpdate = SDL_GetTicks();
-                continue;
-            }
+            scene->r.emplace_or_replace<AnimationComponent>(entity, compileAnimation(spriteComponent, scene->clock()));
+        }
+    }
 
-            float timeSinceLastUpdate = now - spriteComponent.lastUpdate;
+    // sprites are drawn in reverse creation order, so the ones a scene
+    // creates last end up at the bottom
+    scene->r.group<SpriteRenderComponent, TransformComponent>().sort([&sprites](const entt::entity lhs, const entt::entity rhs) {
+        return sprites.index(lhs) > sprites.index(rhs);
+    });
 
-            if (spriteComponent.delay != 0) {
-                if (timeSinceLastUpdate < spriteComponent.delay) {
-                    continue;
-                } else {
-                    spriteComponent.delay = 0;
-                    spriteComponent.lastUpdate = 0;
-                    timeSinceLastUpdate = 0;
-                }
-            }
+    TextureLoader::Enqueue(atlas);
+}
 
-            int framesToUpdate = static_cast<int>(
-                timeSinceLastUpdate / 
-                spriteComponent.animationDuration * spriteComponent.animationFrames
-            );
-
-            if (framesToUpdate > 0) {
-                if (!spriteComponent.once || spriteComponent.xIndex < (spriteComponent.animationFrames - 1)) {
-                    spriteComponent.xIndex += framesToUpdate;
-                    spriteComponent.xIndex %= spriteComponent.animationFrames;
-                    spriteComponent.lastUpdate = now;
-                }
-            }
+SpriteUpdateSystem::SpriteUpdateSystem() {
+    reads<AnimationComponent>();
+    writes<SpriteRenderComponent>();
+}
+
+void SpriteUpdateSystem::run(double dT) {
+    auto view = scene->r.view<AnimationComponent, SpriteRenderComponent>();
+    const Uint32 now = scene->clock();
+
+    for(const auto [entity, animationComponent, spriteComponent] : view.each()) {
+        int frame = animationComponent.frameAt(now);
+        if (frame != spriteComponent.xIndex) {
+            spriteComponent.xIndex = frame;
+            scene->markDirty();
         }
     }
 }
@@ -188,37 +275,50 @@ FadeSetupSystem::FateSetupSystem(SDL_Renderer* renderer, SDL_Window* window)
     : renderer(renderer),  { }
 
 void FateSetupSystem::run() {
-    if (scene->world == nullptr) {
-        scene->world = new Entity(scene->r.create(), scene);
+    if (!scene->world) {
+        scene->world = scene->create();
     }
     SDL_Color fadeColor = {226, 246, 228};
     SDL_Surface* screen = SDL_GetWindowSurface(window);
     SDL_Surface* fade = SDL_CreateRGBSurface(0, screen->w, screen->h, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
     SDL_FillRect(fade, NULL, SDL_MapRGB(fade->format, fadeColor.r, fadeColor.g, fadeColor.b));
-    scene->world->addComponent<FadeComponent>(fadeColor, 500);
+    scene->world.addComponent<FadeComponent>(fadeColor, 500);
 }
 
 void UiUpdateSystem::run(double dT) {
-    auto& uiSpriteComponent = scene->world->get<SpriteComponent>();
-    int affection = scene->player->get<PlayerEmotionComponent>().affection;
+    auto& uiSpriteComponent = scene->world.get<SpriteComponent>();
+    int affection = scene->player.get<PlayerEmotionComponent>().affection;
 
     uiSpriteComponent.xIndex = static_cast<int>(affection / 16);
 }
 */
 
-BlushSetupSystem::BlushSetupSystem(SDL_Renderer* renderer)
-    : renderer(renderer) { }
+BlushSetupSystem::BlushSetupSystem(SDL_Renderer* renderer, PixelShader palette)
+    : renderer(renderer), palette(palette) { }
+
+BlushSetupSystem::~BlushSetupSystem() {
+    TextureManager::UnloadTexture(blush);
+}
+
+void BlushSetupSystem::prepare() {
+    blush = TextureManager::LoadIndexedTexture("Characters/blush.png", renderer, palette);
+}
 
 void BlushSetupSystem::run() {
-    TextureManager::LoadTexture("Characters/blush.png", renderer);
+    scene->player.addComponent<BlushComponent>(blush);
 }
 
+BlushRenderSystem::BlushRenderSystem(SDL_Color tint)
+    : tint(tint) { }
+
 void BlushRenderSystem::run(SDL_Renderer* renderer) {
     const auto& affection = scene->r.ctx().get<AffectionComponent>().affection;
-    auto& playerSpriteComponent = scene->player->get<SpriteComponent>();
+    const auto& playerSpriteComponent = scene->player.get<SpriteRenderComponent>();
+
+    const TextureHandle& handle = scene->player.get<BlushComponent>().texture;
+    IndexedTexture* texture = TextureManager::GetIndexedTexture(handle);
 
-    if (affection > 80) {
-        Texture* texture = TextureManager::GetTexture("Characters/blush.png");
+    if (affection > 80 && texture != nullptr) {
 
         const int width = texture->width;
         const int height = 65;
@@ -230,7 +330,10 @@ void BlushRenderSystem::run(SDL_Renderer* renderer) {
             height,
         };
         
+        // the texture is shared between scenes, so the tint is set every time
+        texture->setColorMod(tint);
         texture->render(
+            handle.palette,
             0,
             24 * SCALE,
             width * SCALE,
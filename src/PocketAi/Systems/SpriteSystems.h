@@ -3,66 +3,106 @@
 #include <SDL2/SDL.h>
 #include <SDL_render.h>
 
+#include <memory>
+#include <vector>
+
 #include "ECS/Components.h"
 #include "ECS/System.h"
+#include "Game/Graphics/LayerCache.h"
+#include "Game/Graphics/SpriteBatch.h"
+#include "Game/Graphics/TextureLoader.h"
+#include "Game/Graphics/TextureAtlas.h"
+#include "Game/Graphics/TextureManager.h"
 
 class UiSetupSystem : public SetupSystem {
 public:
-  UiSetupSystem(SDL_Renderer* renderer, std::string spriteFile, int day = 0);
-  ~UiSetupSystem();
+  UiSetupSystem(SDL_Renderer* renderer, std::string spriteFile, int day = 0, PixelShader palette = {nullptr, ""});
+  void prepare() override;
   void run() override;
   
 private:
   SDL_Renderer* renderer;
   std::string spriteFile;
   int day;
+  PixelShader palette;
 };
 
 class UiUpdateSystem : public UpdateSystem {
 public:
+  UiUpdateSystem();
   void run(double dT) override;
 };
 
 class BackgroundSetupSystem : public SetupSystem {
 public:
-  BackgroundSetupSystem(int day = 0);
-  ~BackgroundSetupSystem();
+  BackgroundSetupSystem(int day = 0, PixelShader palette = {nullptr, ""});
+  void prepare() override;
   void run() override;
 
 private:
   int day;
-  Entity* bg;
+  PixelShader palette;
 };
 
+// static sprites (no animation frames) are composited once into cached
+// layers at native resolution, animated ones are drawn on top every frame.
+// layers keep the draw order of the view, so an animated sprite between two
+// static ones splits them into separate caches. the tint is applied at
+// render time, so changing it never recomposites
 class SpriteRenderSystem : public RenderSystem {
 public:
+  SpriteRenderSystem(SDL_Color tint = { 255, 255, 255, 255 });
   void run(SDL_Renderer* renderer) override;
+
+private:
+  struct StaticLayer {
+    const AtlasRegion* region;
+    int x;
+    int y;
+
+    bool operator==(const StaticLayer& other) const;
+  };
+
+  struct LayerRun {
+    std::vector<StaticLayer> layers;
+    std::unique_ptr<LayerCache> cache;
+  };
+
+  bool flush(SDL_Renderer* renderer, size_t runIndex);
+
+  SDL_Color tint;
+  SpriteBatch batch;
+  std::vector<StaticLayer> pending;
+  std::vector<LayerRun> runs;
 };
 
+// packs every sprite sheet of the scene into an atlas and resolves the
+// sprite components to their frames. decoding and upload happen in the
+// background, sprites show up once their atlas is ready
 class SpriteSetupSystem : public SetupSystem {
 public:
   SpriteSetupSystem(SDL_Renderer* renderer);
-  ~SpriteSetupSystem();
 
   void run() override;
 
 private:
   SDL_Renderer* renderer;
+  std::shared_ptr<TextureAtlas> atlas;
 }; 
 
 class SpriteUpdateSystem : public UpdateSystem {
 public:
+  SpriteUpdateSystem();
   void run(double dT) override;
 };
 
 class SlideShowSetupSystem : public SetupSystem {
 public:
   SlideShowSetupSystem(SpriteComponent sprite, short slideCount = 0, int slideDurationMillis = -1);
-  ~SlideShowSetupSystem();
+  void prepare() override;
   void run() override;
 
 private:
-  Entity* slider;  // we keep this reference to delete it later
   SpriteComponent sprite;
   short slideCount;
   int slideDurationMillis;
@@ -70,20 +110,28 @@ private:
 
 class SlideShowUpdateSystem : public UpdateSystem {
 public:
+  SlideShowUpdateSystem();
   void run(double dT) override;
 };
 
 class BlushSetupSystem : public SetupSystem {
 public:
-  BlushSetupSystem(SDL_Renderer* renderer);
+  BlushSetupSystem(SDL_Renderer* renderer, PixelShader palette = {nullptr, ""});
+  ~BlushSetupSystem();
+  void prepare() override;
   void run() override;
 private:
   SDL_Renderer* renderer;
+  PixelShader palette;
+  TextureHandle blush;
 };
 
 class BlushRenderSystem : public RenderSystem {
 public:
+  BlushRenderSystem(SDL_Color tint = { 255, 255, 255, 255 });
   void run(SDL_Renderer* renderer) override;
+private:
+  SDL_Color tint;
 };
 
 
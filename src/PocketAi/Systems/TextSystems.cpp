@@ -13,6 +13,7 @@
 
 #include "ECS/Entity.h"
 #include "ECS/Components.h"
+#include "Game/AssetArchive.h"
 #include "Game/Graphics/TextureManager.h"
 
 #include "PocketAi/Components.h"
@@ -21,20 +22,22 @@
 PlayerTextSetupSystem::PlayerTextSetupSystem(int textPositionX, int textPositionY, int maxLineLength, int maxLines, SDL_Color textColor)
     : textPositionX(textPositionX), textPositionY(textPositionY), maxLineLength(maxLineLength), maxLines(maxLines), textColor(textColor) { }
 
-void PlayerTextSetupSystem::run() {
-    short fontSize = 5 * SCALE;
-
-    TTF_Font* font = TTF_OpenFont("assets/Fonts/GamergirlClassic.ttf", fontSize);
+void PlayerTextSetupSystem::prepare() {
+    font = TTF_OpenFontRW(AssetArchive::OpenRW("assets/Fonts/GamergirlClassic.ttf"), 1, 5 * SCALE);
     if (!font) {
         print("Failed to load font: %s\n", TTF_GetError());
         exit(1);
     }
+}
+
+void PlayerTextSetupSystem::run() {
+    short fontSize = 5 * SCALE;
 
-    if (scene->player == nullptr) {
-        scene->player = new Entity(scene->r.create(), scene);
+    if (!scene->player) {
+        scene->player = scene->create();
     }
 
-    auto& p = scene->player->get<PlayerTextComponent>(
+    auto& p = scene->player.get<PlayerTextComponent>(
         textPositionX,
         textPositionY,
         textColor,
@@ -45,9 +48,14 @@ void PlayerTextSetupSystem::run() {
     );
 }
 
+PlayerTextInputSystem::PlayerTextInputSystem() {
+    listensTo(SDL_TEXTINPUT);
+    listensToKeys(SDLK_BACKSPACE, SDLK_RETURN, SDLK_KP_ENTER, SDLK_ESCAPE);
+}
+
 void PlayerTextInputSystem::run(SDL_Event event) {
-    auto& playerTextComponent = scene->player->get<PlayerTextComponent>();
-    auto& playerPromptComponent = scene->player->get<PlayerPromptComponent>();
+    auto& playerTextComponent = scene->player.get<PlayerTextComponent>();
+    auto& playerPromptComponent = scene->player.get<PlayerPromptComponent>();
 
     if (!playerPromptComponent.isInteracting) {
         // we ignore all input if we are not interacting
@@ -56,17 +64,35 @@ void PlayerTextInputSystem::run(SDL_Event event) {
 
     if (event.type == SDL_TEXTINPUT) {
         playerTextComponent.text += event.text.text;
-    } else  if (event.type == SDL_KEYDOWN && !playerTextComponent.text.empty()) {
+        scene->markDirty();
+        return;
+    }
+
+    // from here on it's one of the keys we listen to
+    if (event.key.keysym.sym == SDLK_ESCAPE) {
+        // small hack to unstuck the systems
+        print("trying to unstuck");
+        playerTextComponent.text += "\n";
+        scene->markDirty();
+        std::string prompt = "\nSorry, can you repeat that?";
+        playerPromptComponent.isInteracting = true;  // this actually should be false, but since this is a safeguard      
+        AiManager::requestQueue.push("Rob: /confused " + prompt);  // slight hack to make her used to answering with emotions
+        return;
+    }
+
+    if (!playerTextComponent.text.empty()) {
         if (playerTextComponent.text == playerPromptComponent.currentPrompt) {
             // we don't allow edition if the prompt is the original
             return;
         }
         if (event.key.keysym.sym == SDLK_BACKSPACE) {
             playerTextComponent.text.pop_back();
+            scene->markDirty();
         } else if (event.key.keysym.sym == SDLK_RETURN || event.key.keysym.sym == SDLK_KP_ENTER) {
             std::size_t pos = playerTextComponent.text.rfind(playerPromptComponent.username);
             if(pos != std::string::npos) {
                 playerTextComponent.text += "\n";
+                scene->markDirty();
                 std::string prompt = playerTextComponent.text.substr(pos + playerPromptComponent.username.size());
                 playerPromptComponent.isInteracting = false;       
                 /* AiManager::requestQueue.push(prompt); */
@@ -75,15 +101,6 @@ void PlayerTextInputSystem::run(SDL_Event event) {
             /* playerTextComponent.text.clear(); */
         }
     }
-    if (event.key.keysym.sym == SDLK_ESCAPE) {
-        // small hack to unstuck the systems
-        print("trying to unstuck");
-        playerTextComponent.text += "\n";
-        std::string prompt = "\nSorry, can you repeat that?";
-        playerPromptComponent.isInteracting = true;  // this actually should be false, but since this is a safeguard      
-        AiManager::requestQueue.push("Rob: /confused " + prompt);  // slight hack to make her used to answering with emotions
-    }
-
 }
 
 void renderLine(SDL_Renderer* renderer, TTF_Font* font, const std::string& line, SDL_Rect& position, SDL_Color color) {
@@ -138,7 +155,7 @@ void handleLine(
 }
 
 void PlayerTextRenderSystem::run(SDL_Renderer* renderer) {
-    auto& playerTextComponent = scene->player->get<PlayerTextComponent>();
+    auto& playerTextComponent = scene->player.get<PlayerTextComponent>();
 
     if (playerTextComponent.text.empty()) {
         return;  // text has 0 length
@@ -187,6 +204,13 @@ void PlayerTextRenderSystem::run(SDL_Renderer* renderer) {
     int text_width;
     int text_height;
     TTF_SizeText(playerTextComponent.font, lines.back().c_str(), &text_width, &text_height);
+
+    // the cursor is placed from this rect, draw once more if it moved
+    SDL_Rect& last = playerTextComponent.lastLineRect;
+    if (last.x != position.x || last.y != position.y || last.w != text_width || last.h != text_height) {
+        scene->markDirty();
+    }
+
     playerTextComponent.lastLineRect.x = position.x;
     playerTextComponent.lastLineRect.y = position.y;
     playerTextComponent.lastLineRect.w = text_width;
@@ -194,13 +218,17 @@ void PlayerTextRenderSystem::run(SDL_Renderer* renderer) {
 }
 
 void PlayerCursorRenderSystem::run(SDL_Renderer* renderer) {
-    bool blink = (SDL_GetTicks() / 500) % 2 == 0;
+    Uint32 now = SDL_GetTicks();
+    bool blink = (now / 500) % 2 == 0;
+
+    // wake the renderer up for the next blink
+    scene->scheduleRedraw((now / 500 + 1) * 500);
 
     if (!blink) {
         return;
     }
 
-    const auto playerTextComponent = scene->player->get<PlayerTextComponent>();
+    const auto& playerTextComponent = scene->player.get<PlayerTextComponent>();
     
     SDL_Rect r = {
         playerTextComponent.lastLineRect.x + playerTextComponent.lastLineRect.w + (1 * SCALE),
@@ -223,31 +251,34 @@ void PlayerCursorRenderSystem::run(SDL_Renderer* renderer) {
 TextCrawlUpdateSystem::TextCrawlUpdateSystem(const std::string& text, int lettersPerSecond)
     : text(text), frameCount(0) {
     framesPerLetter = 60 / lettersPerSecond;
+    writes<PlayerTextComponent>();
 }
 
 void TextCrawlUpdateSystem::run(double dT) {
-    auto& playerTextComponent = scene->player->get<PlayerTextComponent>();
+    auto& playerTextComponent = scene->player.get<PlayerTextComponent>();
 
     if (playerTextComponent.text.size() < text.size() && ++frameCount >= framesPerLetter) {
       if (playerTextComponent.text.size() < text.size()) {
         playerTextComponent.text += text[playerTextComponent.text.size()];
+        scene->markDirty();
       }
       frameCount = 0;
     }
 }
 
 TextCrawlEventSystem::TextCrawlEventSystem(const std::string& text, std::function<void()> changeScene)
-    : text(text), changeScene(changeScene) { }
+    : text(text), changeScene(changeScene) {
+    listensToKeys(SDLK_RETURN);
+}
 
 void TextCrawlEventSystem::run(SDL_Event event) {
-    auto& playerTextComponent = scene->player->get<PlayerTextComponent>();
-
-    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_RETURN) {
-        if (playerTextComponent.text.size() < text.size()) {
-            playerTextComponent.text = text;
-        } else {
-            print("next scene!");
-            changeScene();
-        }
+    auto& playerTextComponent = scene->player.get<PlayerTextComponent>();
+
+    if (playerTextComponent.text.size() < text.size()) {
+        playerTextComponent.text = text;
+        scene->markDirty();
+    } else {
+        print("next scene!");
+        changeScene();
     }
 }
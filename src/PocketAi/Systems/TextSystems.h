@@ -2,11 +2,14 @@
 
 #include <SDL2/SDL.h>
 #include <SDL_render.h>
+#include <SDL2/SDL_ttf.h>
 
 #include "ECS/System.h"
+#include "PocketAi/Palettes.h"
 
 class PlayerTextInputSystem : public EventSystem {
 public:
+  PlayerTextInputSystem();
   void run(SDL_Event event) override;
 };
 
@@ -17,11 +20,13 @@ public:
     int textPositionY = 100,
     int maxLineLength = 28,
     int maxLines = 7,
-    SDL_Color textColor = {226, 246, 228}
+    SDL_Color textColor = ClassicPalette[3]
     /* SDL_Color textColor = { 51,  44,  80} */
   );
+  void prepare() override;
   void run() override;
 private:
+  TTF_Font* font = nullptr;
   int textPositionX;
   int textPositionY;
   int maxLineLength;
@@ -0,0 +1,63 @@
+#include "EventRouter.h"
+
+#include "ECS/System.h"
+
+EventRouter::EventRouter()
+{
+  built = false;
+}
+
+void EventRouter::build(const std::pmr::vector<std::shared_ptr<EventSystem>>& systems)
+{
+  routes.clear();
+  fallback.clear();
+
+  std::vector<Uint32> types;
+  for (const auto& system : systems) {
+    const EventSubscription& subscription = system->getSubscription();
+
+    if (!subscription.declared) {
+      fallback.push_back({ system.get(), &subscription });
+      continue;
+    }
+
+    types.insert(types.end(), subscription.types.begin(), subscription.types.end());
+    if (!subscription.keys.empty()) {
+      types.push_back(SDL_KEYDOWN);
+    }
+  }
+
+  for (Uint32 type : types) {
+    if (routes.contains(type)) {
+      continue;
+    }
+
+    std::vector<Route>& route = routes[type];
+    for (const auto& system : systems) {
+      const EventSubscription& subscription = system->getSubscription();
+      if (subscription.routes(type)) {
+        route.push_back({ system.get(), &subscription });
+      }
+    }
+  }
+
+  built = true;
+}
+
+void EventRouter::dispatch(const SDL_Event& event) const
+{
+  auto it = routes.find(event.type);
+  const std::vector<Route>& route = it != routes.end() ? it->second : fallback;
+
+  for (const Route& r : route) {
+    // a key subscription shares the SDL_KEYDOWN route with other keys
+    if (r.subscription->wants(event)) {
+      r.system->run(event);
+    }
+  }
+}
+
+bool EventRouter::isBuilt() const
+{
+  return built;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+class EventSystem;
+struct EventSubscription;
+
+// Hands each event only to the event systems subscribed to its type, looked
+// up in a table built once from their subscriptions. Systems that subscribed
+// to nothing get every event. Within a type systems keep the order they were
+// added in.
+class EventRouter {
+  public:
+    EventRouter();
+
+    void build(const std::pmr::vector<std::shared_ptr<EventSystem>>& systems);
+    void dispatch(const SDL_Event& event) const;
+    bool isBuilt() const;
+
+  private:
+    struct Route {
+      EventSystem* system;
+      const EventSubscription* subscription;
+    };
+
+    bool built;
+    std::unordered_map<Uint32, std::vector<Route>> routes;
+    std::vector<Route> fallback;  // types nobody subscribed to
+};
@@ -10,44 +10,89 @@
 
 
 Scene::Scene(const std::string& name, entt::registry& r)
-  : name(name), r(r)
+  : arena(arenaBuffer, sizeof(arenaBuffer)),
+    setupSystems(&arena),
+    eventSystems(&arena),
+    updateSystems(&arena),
+    renderSystems(&arena),
+    name(name),
+    r(r),
+    entities(&arena)
 {
-  world = nullptr;
-  mainCamera = nullptr;
-  player = nullptr;
+  prepared = false;
+  elapsed = 0;
+  dirty = true;
+  redrawAt = 0;
   /*
-  world = new Entity(r.create(), this);
-  world->addComponent<TilemapComponent>();
-  world->addComponent<WorldComponent>(800 * 5, 600 * 5);
-
-  mainCamera = new Entity(r.create(), this);
-  mainCamera->addComponent<TransformComponent>(0, 0);
-  mainCamera->addComponent<CameraComponent>(5, 800, 600);
-
-  player = new Entity(r.create(), this);
-  player->addComponent<TransformComponent>(500, 500);
-  player->addComponent<BoxColliderComponent>(16, 16, 16, 16);
-  player->addComponent<SpeedComponent>(0, 0);
+  world = create();
+  world.addComponent<TilemapComponent>();
+  world.addComponent<WorldComponent>(800 * 5, 600 * 5);
+
+  mainCamera = create();
+  mainCamera.addComponent<TransformComponent>(0, 0);
+  mainCamera.addComponent<CameraComponent>(5, 800, 600);
+
+  player = create();
+  player.addComponent<TransformComponent>(500, 500);
+  player.addComponent<BoxColliderComponent>(16, 16, 16, 16);
+  player.addComponent<SpeedComponent>(0, 0);
   */
 }
 
 Scene::~Scene()
 {
+  // the registry is shared with the other scenes, so we only take ours
+  std::erase_if(entities, [this](entt::entity e) { return !r.valid(e); });
+  r.destroy(entities.begin(), entities.end());
+
   print("Scene Destroyed!");
 }
 
-Entity* Scene::createEntity(const std::string& name, int x, int y)
+std::pmr::memory_resource* Scene::memory()
+{
+  return &arena;
+}
+
+Entity Scene::create()
+{
+  entt::entity e = r.create();
+  entities.push_back(e);
+  return Entity(e, r);
+}
+
+Entity Scene::createEntity(const std::string& name, int x, int y)
 {
   /* print("Create entity", name); */
-  Entity* entity = new Entity(r.create(), this );
-  entity->addComponent<NameComponent>(name);
-  entity->addComponent<TransformComponent>(x, y);
+  Entity entity = create();
+  entity.addComponent<NameComponent>(name);
+  entity.addComponent<TransformComponent>(x, y);
 
   return entity;
 }
 
+void Scene::prepare()
+{
+  if (prepared) {
+    return;
+  }
+
+  print("Scene Prepare", name);
+  prepared = true;
+
+  for (auto sys: setupSystems)
+  {
+    sys->prepare();
+  }
+}
+
+bool Scene::isPrepared() const
+{
+  return prepared;
+}
+
 void Scene::setup()
 {
+  prepare();
   print("Scene Setup", name);
   
   for (auto sys: setupSystems)
@@ -59,16 +104,27 @@ void Scene::setup()
 void Scene::update(double dT)
 {
   // print("Scene Update");
-  
-  for (auto sys: updateSystems)
-  {
-    sys->run(dT);
+
+  if (!scheduler.isBuilt()) {
+    scheduler.build(updateSystems, r);
   }
+
+  scheduler.run(dT);
+  elapsed += dT * 1000.0;
+}
+
+Uint32 Scene::clock() const
+{
+  return static_cast<Uint32>(elapsed);
 }
 
 void Scene::render(SDL_Renderer* renderer)
 {
   // print("Scene Render");
+
+  // render systems may mark or schedule the next redraw while running
+  dirty = false;
+  redrawAt = 0;
   
   for (auto sys: renderSystems)
   {
@@ -76,13 +132,33 @@ void Scene::render(SDL_Renderer* renderer)
   }
 }
 
-void Scene::processEvents(SDL_Event event)
+void Scene::processEvents(const std::vector<SDL_Event>& events)
 {
   // print("Scene Events");
-  
-  for (auto sys: eventSystems)
+
+  if (!router.isBuilt()) {
+    router.build(eventSystems);
+  }
+
+  for (const SDL_Event& event : events)
   {
-    sys->run(event);
+    router.dispatch(event);
+  }
+}
+
+void Scene::markDirty()
+{
+  dirty = true;
+}
+
+void Scene::scheduleRedraw(Uint32 at)
+{
+  if (redrawAt == 0 || at < redrawAt) {
+    redrawAt = at;
   }
 }
 
+bool Scene::needsRedraw(Uint32 now) const
+{
+  return dirty || (redrawAt != 0 && now >= redrawAt);
+}
@@ -2,21 +2,35 @@
 
 #include <SDL2/SDL.h>
 #include <string>
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
 #include <entt/entt.hpp>
+#include "ECS/Entity.h"
+#include "Scene/SystemScheduler.h"
+#include "Scene/EventRouter.h"
 
-class Entity;
 class SetupSystem;
 class EventSystem;
 class UpdateSystem;
 class RenderSystem;
 
 class Scene {
+    // everything the scene allocates while it is built dies with it, so it
+    // comes from a monotonic arena that is released in one go. declared
+    // first so it outlives the members allocated from it. main thread only
+    alignas(std::max_align_t) std::byte arenaBuffer[8192];
+    std::pmr::monotonic_buffer_resource arena;
+
   public:
-    std::vector<std::shared_ptr<SetupSystem>> setupSystems;
-    std::vector<std::shared_ptr<EventSystem>> eventSystems;
-    std::vector<std::shared_ptr<UpdateSystem>> updateSystems;
-    std::vector<std::shared_ptr<RenderSystem>> renderSystems;
+    std::pmr::vector<std::shared_ptr<SetupSystem>> setupSystems;
+    std::pmr::vector<std::shared_ptr<EventSystem>> eventSystems;
+    std::pmr::vector<std::shared_ptr<UpdateSystem>> updateSystems;
+    std::pmr::vector<std::shared_ptr<RenderSystem>> renderSystems;
     std::string name;
+    SystemScheduler scheduler;
+    EventRouter router;
 
     Scene(const std::string&, entt::registry& r);
     ~Scene();
@@ -25,20 +39,46 @@ class Scene {
     Scene(const Scene&) = delete;
     Scene& operator=(const Scene&) = delete;
 
-    Entity* world;
-    Entity* mainCamera;
-    Entity* player;
+    Entity world;
+    Entity mainCamera;
+    Entity player;
 
     entt::registry& r;
 
-    Entity* createEntity(
+    // for systems and other data that lives exactly as long as the scene
+    std::pmr::memory_resource* memory();
+
+    // entities belong to the scene, they are all destroyed with it
+    Entity create();
+    Entity createEntity(
       const std::string& name = "NO NAME",
       int x = 0,
       int y = 0
     );
     
+    // kicks off asset loading for the scene, runs once and is cheap to call
+    // while the previous scene plays. setup() prepares if nobody did
+    void prepare();
+    bool isPrepared() const;
     void setup();
     void update(double dT);
+    // milliseconds simulated since setup, it only moves in fixed update
+    // steps so everything timed against it is deterministic
+    Uint32 clock() const;
     void render(SDL_Renderer* renderer);
-    void processEvents(SDL_Event event);
+    // the events polled this frame, in order
+    void processEvents(const std::vector<SDL_Event>& events);
+
+    // systems mark the scene dirty when what's on screen changed, or schedule
+    // a redraw for a known moment (a blink), otherwise the frame is skipped
+    void markDirty();
+    void scheduleRedraw(Uint32 at);
+    bool needsRedraw(Uint32 now) const;
+
+  private:
+    std::pmr::vector<entt::entity> entities;
+    bool prepared;
+    double elapsed;
+    std::atomic<bool> dirty;
+    Uint32 redrawAt;
 };
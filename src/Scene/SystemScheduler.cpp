@@ -0,0 +1,81 @@
+#include "SystemScheduler.h"
+
+#include <cstdlib>
+#include <print.h>
+#include <tbb/parallel_for_each.h>
+#include <tbb/task_arena.h>
+
+#include "ECS/System.h"
+
+SystemScheduler::SystemScheduler()
+{
+  serial = std::getenv("SERIAL_SYSTEMS") != nullptr;
+  built = false;
+}
+
+void SystemScheduler::build(const std::pmr::vector<std::shared_ptr<UpdateSystem>>& systems, entt::registry& r)
+{
+  ordered.clear();
+  stages.clear();
+
+  std::vector<size_t> stageOf;
+  stageOf.reserve(systems.size());
+
+  for (size_t i = 0; i < systems.size(); i++) {
+    const SystemAccess& access = systems[i]->getAccess();
+
+    for (auto storage : access.storages) {
+      storage(r);
+    }
+
+    // a system goes right after the last stage holding something it conflicts with
+    size_t stage = 0;
+    for (size_t j = 0; j < i; j++) {
+      if (access.conflictsWith(systems[j]->getAccess())) {
+        stage = std::max(stage, stageOf[j] + 1);
+      }
+    }
+
+    if (stage >= stages.size()) {
+      stages.resize(stage + 1);
+    }
+
+    stages[stage].push_back(systems[i].get());
+    stageOf.push_back(stage);
+    ordered.push_back(systems[i].get());
+  }
+
+  /* print("Scheduled", systems.size(), "update systems in", stages.size(), "stages"); */
+  built = true;
+}
+
+void SystemScheduler::run(double dT)
+{
+  if (serial) {
+    for (auto sys : ordered) {
+      sys->run(dT);
+    }
+    return;
+  }
+
+  for (auto& stage : stages) {
+    if (stage.size() == 1) {
+      stage.front()->run(dT);
+      continue;
+    }
+
+    // isolated so this thread only helps with this stage's systems while it
+    // waits, not with whatever else is in the pool. model work can't be
+    // picked up here either way, AiManager runs it in its own arena
+    tbb::this_task_arena::isolate([&stage, dT] {
+      tbb::parallel_for_each(stage.begin(), stage.end(), [dT](UpdateSystem* sys) {
+        sys->run(dT);
+      });
+    });
+  }
+}
+
+bool SystemScheduler::isBuilt() const
+{
+  return built;
+}
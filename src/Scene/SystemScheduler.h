@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <entt/entt.hpp>
+
+class UpdateSystem;
+
+// Groups update systems into stages from their declared component access.
+// Systems inside a stage don't conflict and run in parallel on the TBB pool,
+// stages run one after the other. Conflicting systems keep the order they
+// were added in.
+class SystemScheduler {
+  public:
+    SystemScheduler();
+
+    void build(const std::pmr::vector<std::shared_ptr<UpdateSystem>>& systems, entt::registry& r);
+    void run(double dT);
+    bool isBuilt() const;
+
+    // run everything on the calling thread in insertion order, for debugging.
+    // defaults to true when SERIAL_SYSTEMS is set in the environment
+    bool serial;
+
+  private:
+    bool built;
+    std::vector<UpdateSystem*> ordered;
+    std::vector<std::vector<UpdateSystem*>> stages;
+};
@@ -0,0 +1,179 @@
+// Packs a directory into the archive the game maps at startup, see
+// src/Game/ArchiveFormat.h for the layout.
+//
+//   pack [--exclude <path>]... [--skip-transcoded] <directory>... <output>
+//
+// Entries are named by their path relative to the directory's parent, so
+// files from the source tree's assets and from a build tree's assets both
+// end up under "assets/". A later directory wins when both have a file. With
+// --skip-transcoded a wav that has an ogg of the same name is left out, the
+// game always prefers the ogg. Files that shrink by more than a tenth are
+// stored lz4 compressed when lz4 was found at build time, formats that are
+// compressed already are stored as they are.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <print.h>
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#include "Game/ArchiveFormat.h"
+
+namespace fs = std::filesystem;
+
+struct PackedFile {
+  std::string name;
+  std::vector<char> bytes;
+  std::uint64_t originalSize;
+  std::uint32_t flags;
+};
+
+static std::vector<char> readFile(const fs::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static bool isCompressedFormat(const fs::path& path) {
+  static const std::vector<std::string> extensions = { ".png", ".ogg", ".flac", ".ttf", ".gguf" };
+  return std::find(extensions.begin(), extensions.end(), path.extension().string()) != extensions.end();
+}
+
+static void compress(PackedFile& file) {
+#ifdef HAVE_LZ4
+  std::vector<char> out(LZ4_compressBound(file.bytes.size()));
+  int written = LZ4_compress_default(file.bytes.data(), out.data(), file.bytes.size(), out.size());
+
+  if (written > 0 && size_t(written) < file.bytes.size() * 9 / 10) {
+    out.resize(written);
+    file.bytes.swap(out);
+    file.flags |= archive::Compressed;
+  }
+#endif
+}
+
+int main(int argc, char** argv) {
+  std::vector<std::string> excludes;
+  bool skipTranscoded = false;
+  std::vector<std::string> positional;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--exclude" && i + 1 < argc) {
+      excludes.push_back(fs::path(argv[++i]).generic_string());
+    } else if (arg == "--skip-transcoded") {
+      skipTranscoded = true;
+    } else {
+      positional.push_back(arg);
+    }
+  }
+
+  if (positional.size() < 2) {
+    std::cerr << "usage: pack [--exclude <path>]... [--skip-transcoded] <directory>... <output>" << std::endl;
+    return 1;
+  }
+
+  const fs::path output = positional.back();
+  positional.pop_back();
+
+  // entry name to file on disk, sorted the way the game binary searches it
+  std::map<std::string, fs::path> sources;
+  for (const std::string& directory : positional) {
+    const fs::path root = fs::absolute(directory).lexically_normal();
+    if (!fs::is_directory(root)) {
+      std::cerr << "not a directory: " << directory << std::endl;
+      return 1;
+    }
+
+    for (const auto& item : fs::recursive_directory_iterator(root)) {
+      if (!item.is_regular_file()) {
+        continue;
+      }
+
+      std::string name = item.path().lexically_relative(root.parent_path()).generic_string();
+
+      bool excluded = std::any_of(excludes.begin(), excludes.end(), [&name](const std::string& prefix) {
+        return name.compare(0, prefix.size(), prefix) == 0;
+      });
+      if (!excluded) {
+        sources[name] = item.path();
+      }
+    }
+  }
+
+  std::vector<PackedFile> files;
+  for (const auto& [name, path] : sources) {
+    if (skipTranscoded && path.extension() == ".wav"
+      && sources.contains(fs::path(name).replace_extension(".ogg").generic_string())) {
+      continue;
+    }
+
+    PackedFile file = { name, readFile(path), 0, 0 };
+    file.originalSize = file.bytes.size();
+    if (!isCompressedFormat(path)) {
+      compress(file);
+    }
+    files.push_back(std::move(file));
+  }
+
+  std::string names;
+  std::vector<archive::Entry> entries(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    entries[i].nameOffset = names.size();
+    entries[i].nameLength = files[i].name.size();
+    entries[i].size = files[i].bytes.size();
+    entries[i].originalSize = files[i].originalSize;
+    entries[i].flags = files[i].flags;
+    entries[i].reserved = 0;
+    names += files[i].name;
+  }
+
+  auto align = [](std::uint64_t offset) {
+    return (offset + archive::Alignment - 1) / archive::Alignment * archive::Alignment;
+  };
+
+  std::uint64_t offset = align(sizeof(archive::Header) + entries.size() * sizeof(archive::Entry) + names.size());
+  for (auto& entry : entries) {
+    entry.offset = offset;
+    offset = align(offset + entry.size);
+  }
+
+  archive::Header header;
+  std::memcpy(header.magic, archive::Magic, sizeof(header.magic));
+  header.version = archive::Version;
+  header.entryCount = entries.size();
+  header.namesSize = names.size();
+
+  std::ofstream out(output, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    std::cerr << "can't write " << output << std::endl;
+    return 1;
+  }
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(archive::Entry));
+  out.write(names.data(), names.size());
+
+  std::uint64_t packed = 0;
+  for (size_t i = 0; i < files.size(); i++) {
+    out.seekp(entries[i].offset);
+    out.write(files[i].bytes.data(), files[i].bytes.size());
+    packed += files[i].originalSize;
+  }
+
+  // pad the last blob so the file ends on a boundary too
+  if (static_cast<std::uint64_t>(out.tellp()) < offset) {
+    out.seekp(offset - 1);
+    out.put(0);
+  }
+
+  print("packed", files.size(), "files,", packed, "bytes into", offset);
+  return out.good() ? 0 : 1;
+}